@@ -0,0 +1,111 @@
+/*
+Part of Scallop Transcript Assembler
+(c) 2017 by  Mingfu Shao, Carl Kingsford, and Carnegie Mellon University.
+See LICENSE for licensing.
+*/
+
+#include "csr_graph.h"
+
+#include <cassert>
+
+using namespace std;
+
+csr_graph::csr_graph()
+{}
+
+int csr_graph::build(directed_graph &gr)
+{
+	clear();
+
+	int n = gr.num_vertices();
+	int m = gr.num_edge_indices();
+	es.assign(m, -1);
+	et.assign(m, -1);
+	ie.reserve(gr.num_edges());
+	oe.reserve(gr.num_edges());
+	ip.reserve(n + 1);
+	op.reserve(n + 1);
+
+	edge_iterator it1, it2;
+	PEEI pei;
+	for(int v = 0; v < n; v++)
+	{
+		ip.push_back(ie.size());
+		for(pei = gr.in_edges(v), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
+		{
+			ie.push_back((*it1)->index());
+		}
+
+		op.push_back(oe.size());
+		for(pei = gr.out_edges(v), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
+		{
+			int k = (*it1)->index();
+			oe.push_back(k);
+			es[k] = (*it1)->source();
+			et[k] = (*it1)->target();
+		}
+	}
+	ip.push_back(ie.size());
+	op.push_back(oe.size());
+	return 0;
+}
+
+int csr_graph::clear()
+{
+	ip.clear();
+	op.clear();
+	ie.clear();
+	oe.clear();
+	es.clear();
+	et.clear();
+	return 0;
+}
+
+size_t csr_graph::num_vertices() const
+{
+	if(ip.size() == 0) return 0;
+	return ip.size() - 1;
+}
+
+int csr_graph::in_degree(int v) const
+{
+	return ip[v + 1] - ip[v];
+}
+
+int csr_graph::out_degree(int v) const
+{
+	return op[v + 1] - op[v];
+}
+
+int csr_graph::degree(int v) const
+{
+	return in_degree(v) + out_degree(v);
+}
+
+vector<int> csr_graph::topological_sort() const
+{
+	// same visiting order as directed_graph::topological_sort
+	int n = num_vertices();
+	vector<int> q;
+	vector<int> vd(n, 0);
+	q.reserve(n);
+	for(int i = 0; i < n; i++)
+	{
+		vd[i] = in_degree(i);
+		if(vd[i] == 0) q.push_back(i);
+	}
+
+	int k = 0;
+	while(k < q.size())
+	{
+		int x = q[k++];
+		for(int j = op[x]; j < op[x + 1]; j++)
+		{
+			int t = et[oe[j]];
+			vd[t]--;
+			assert(vd[t] >= 0);
+			if(vd[t] == 0) q.push_back(t);
+		}
+	}
+	return q;
+}
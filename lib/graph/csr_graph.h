@@ -0,0 +1,43 @@
+/*
+Part of Scallop Transcript Assembler
+(c) 2017 by  Mingfu Shao, Carl Kingsford, and Carnegie Mellon University.
+See LICENSE for licensing.
+*/
+
+#ifndef __CSR_GRAPH_H__
+#define __CSR_GRAPH_H__
+
+#include <vector>
+
+#include "directed_graph.h"
+
+using namespace std;
+
+// frozen snapshot of a directed graph in compressed sparse row form;
+// edges are given by their dense indices in the graph, and the adjacency
+// of each vertex keeps the order of in_edges / out_edges;
+// the snapshot is stale once the graph is modified
+class csr_graph
+{
+public:
+	csr_graph();
+
+public:
+	vector<int> ip;		// in-edges of v are ie[ip[v]] ... ie[ip[v + 1] - 1]
+	vector<int> op;		// out-edges of v are oe[op[v]] ... oe[op[v + 1] - 1]
+	vector<int> ie;		// edge indices grouped by target
+	vector<int> oe;		// edge indices grouped by source
+	vector<int> es;		// source of each edge index, -1 if unused
+	vector<int> et;		// target of each edge index, -1 if unused
+
+public:
+	int build(directed_graph &gr);
+	int clear();
+	size_t num_vertices() const;
+	int in_degree(int v) const;
+	int out_degree(int v) const;
+	int degree(int v) const;
+	vector<int> topological_sort() const;
+};
+
+#endif
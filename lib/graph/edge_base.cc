@@ -10,7 +10,7 @@ See LICENSE for licensing.
 using namespace std;
 
 edge_base::edge_base(int _s, int _t)
-	:s(_s), t(_t)
+	:s(_s), t(_t), k(-1), c(-1)
 {}
 
 int edge_base::move(int x, int y)
@@ -20,6 +20,28 @@ int edge_base::move(int x, int y)
 	return 0;
 }
 
+int edge_base::set_index(int x)
+{
+	k = x;
+	return 0;
+}
+
+int edge_base::index() const
+{
+	return k;
+}
+
+int edge_base::set_serial(int x)
+{
+	c = x;
+	return 0;
+}
+
+int edge_base::serial() const
+{
+	return c;
+}
+
 int edge_base::swap()
 {
 	int x = s;
@@ -9,6 +9,7 @@ See LICENSE for licensing.
 
 #include <set>
 #include <map>
+#include <vector>
 
 using namespace std;
 
@@ -16,26 +17,42 @@ using namespace std;
 
 class edge_base
 {
+	friend class edge_compare;
+
 public:
 	edge_base(int _s, int _t);
 
 protected:
 	int s;					// source
 	int t;					// target
+	int k;					// dense index, assigned by the graph
+	int c;					// serial number, assigned by the graph
 
 public:
 	virtual int move(int x, int y);
+	virtual int set_index(int x);
+	virtual int index() const;
+	virtual int set_serial(int x);
+	virtual int serial() const;
 	virtual int swap();
 	virtual int source() const;
 	virtual int target() const;
 	virtual int print() const;
 };
 
+// order edges by creation rather than by address, such that
+// iterations over edges do not depend on the memory layout
+class edge_compare
+{
+public:
+	bool operator()(const edge_base *x, const edge_base *y) const { return x->c < y->c; }
+};
+
 typedef edge_base* edge_descriptor;
-typedef set<edge_base*>::iterator edge_iterator;
+typedef vector<edge_base*>::const_iterator edge_iterator;
 typedef pair<edge_descriptor, bool> PEB;
 typedef pair<edge_descriptor, edge_descriptor> PEE;
-typedef map<edge_descriptor, edge_descriptor> MEE;
+typedef map<edge_descriptor, edge_descriptor, edge_compare> MEE;
 typedef pair<edge_iterator, edge_iterator> PEEI;
 
 #endif
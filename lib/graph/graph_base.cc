@@ -15,6 +15,7 @@ See LICENSE for licensing.
 using namespace std;
 
 graph_base::graph_base()
+	: nd(0), ns(0)
 {}
 
 graph_base::~graph_base()
@@ -23,23 +24,61 @@ graph_base::~graph_base()
 }
 
 graph_base::graph_base(const graph_base &gr)
+	: nd(0), ns(0)
 {
 	//copy(gr); !!!
 }
 
 int graph_base::copy(const graph_base &gr)
 {
+	// edges keep their indices and serials, so the clone copies the
+	// edge pool as a whole and only translates pointers by index
 	clear();
-	for(int i = 0; i < gr.num_vertices(); i++) add_vertex();
+	gr.compact();
+	ep = gr.ep;
+	fe = gr.fe;
+	ss = gr.ss;
+	ns = gr.ns;
+
+	ve.assign(gr.ve.size(), null_edge);
+	for(int k = 0; k < gr.ve.size(); k++)
+	{
+		if(gr.ve[k] != null_edge) ve[k] = &ep[k];
+	}
 
-	PEEI p = gr.edges();
-	for(edge_iterator it = p.first; it != p.second; it++)
+	se.reserve(gr.se.size());
+	for(edge_iterator it = gr.se.begin(); it != gr.se.end(); it++)
 	{
-		add_edge((*it)->source(), (*it)->target());
+		se.push_back(ve[(*it)->index()]);
+	}
+
+	vv.reserve(gr.vv.size());
+	for(int i = 0; i < gr.vv.size(); i++)
+	{
+		vertex_base *v = new vertex_base();
+		PEEI pi = gr.vv[i]->in_edges();
+		PEEI po = gr.vv[i]->out_edges();
+		for(edge_iterator it = pi.first; it != pi.second; it++) v->add_in_edge(ve[(*it)->index()]);
+		for(edge_iterator it = po.first; it != po.second; it++) v->add_out_edge(ve[(*it)->index()]);
+		vv.push_back(v);
 	}
 	return 0;
 }
 
+int graph_base::swap(graph_base &gr)
+{
+	// pointers into ep stay valid, they now belong to the other graph
+	vv.swap(gr.vv);
+	ep.swap(gr.ep);
+	se.swap(gr.se);
+	ss.swap(gr.ss);
+	std::swap(nd, gr.nd);
+	ve.swap(gr.ve);
+	fe.swap(gr.fe);
+	std::swap(ns, gr.ns);
+	return 0;
+}
+
 int graph_base::add_vertex()
 {
 	vertex_base *v = new vertex_base();
@@ -70,12 +109,54 @@ int graph_base::clear_vertex(int x)
 int graph_base::clear()
 {
 	for(int i = 0; i < vv.size(); i++) delete vv[i];
-	for(edge_iterator it = se.begin(); it != se.end(); it++)
-	{
-		delete (*it);
-	}
 	vv.clear();
+	ep.clear();
 	se.clear();
+	ss.clear();
+	nd = 0;
+	ve.clear();
+	fe.clear();
+	ns = 0;
+	return 0;
+}
+
+edge_base* graph_base::insert_edge(int s, int t)
+{
+	// reuse a released index to keep indices dense
+	if(fe.size() == 0)
+	{
+		fe.push_back(ve.size());
+		ve.push_back(null_edge);
+		ep.push_back(edge_base(s, t));
+	}
+	int k = fe.back();
+	fe.pop_back();
+
+	edge_base *e = &ep[k];
+	*e = edge_base(s, t);
+	e->set_index(k);
+	ve[k] = e;
+
+	// a new edge comes after all existing ones
+	e->set_serial(ns);
+	se.push_back(e);
+	ss.push_back(ns);
+	ns++;
+	return e;
+}
+
+int graph_base::erase_edge(edge_base *e)
+{
+	// leave a hole in se, which is closed by the next edges(); erasing
+	// here would make removing many edges quadratic
+	int p = lower_bound(ss.begin(), ss.end(), e->serial()) - ss.begin();
+	if(p >= ss.size() || se[p] != e) return -1;
+	se[p] = null_edge;
+	nd++;
+
+	int k = e->index();
+	ve[k] = null_edge;
+	fe.push_back(k);
 	return 0;
 }
 
@@ -112,8 +193,26 @@ vector<edge_descriptor> graph_base::edges(int s, int t)
 	return v;
 }
 
+int graph_base::compact() const
+{
+	if(nd == 0) return 0;
+	int n = 0;
+	for(int i = 0; i < se.size(); i++)
+	{
+		if(se[i] == null_edge) continue;
+		se[n] = se[i];
+		ss[n] = ss[i];
+		n++;
+	}
+	se.resize(n);
+	ss.resize(n);
+	nd = 0;
+	return 0;
+}
+
 PEEI graph_base::edges() const
 {
+	compact();
 	return PEEI(se.begin(), se.end());
 }
 
@@ -148,26 +247,37 @@ size_t graph_base::num_vertices() const
 
 size_t graph_base::num_edges() const
 {
-	return se.size();
+	return se.size() - nd;
+}
+
+size_t graph_base::num_edge_indices() const
+{
+	return ve.size();
+}
+
+edge_descriptor graph_base::get_edge(int k) const
+{
+	assert(k >= 0 && k < ve.size());
+	return ve[k];
 }
 
-int graph_base::get_edge_indices(VE &i2e, MEI &e2i)
+int graph_base::get_edge_indices(VE &i2e, vector<int> &e2i)
 {
 	i2e.clear();
-	e2i.clear();
+	e2i.assign(ve.size(), -1);
 	int index = 0;
 	PEEI pei = edges();
 	edge_iterator it1 = pei.first, it2 = pei.second;
 	for(; it1 != it2; it1++)
 	{
-		e2i.insert(PEI(*it1, index));
+		e2i[(*it1)->index()] = index;
 		i2e.push_back(*it1);
 		index++;
 	}
 	return 0;
 }
 
-bool graph_base::bfs(const vector<int> &vs, int t, const set<edge_descriptor> &fb)
+bool graph_base::bfs(const vector<int> &vs, int t, const SE &fb)
 {
 	set<int> closed(vs.begin(), vs.end());
 	vector<int> open = vs;
@@ -222,7 +332,7 @@ int graph_base::bfs(int s, vector<int> &v, vector<int> &b)
 	return 0;
 }
 
-int graph_base::bfs(int s, set<edge_descriptor> &ss)
+int graph_base::bfs(int s, SE &ss)
 {
 	ss.clear();
 	set<int> closed;
@@ -257,7 +367,7 @@ int graph_base::bfs(int t, vector<int> &v)
 
 bool graph_base::check_path(int s, int t) 
 {
-	set<edge_descriptor> fb;
+	SE fb;
 	vector<int> ss;
 	ss.push_back(s);
 	return bfs(ss, t, fb);
@@ -310,14 +420,15 @@ bool graph_base::check_nested()
 
 int graph_base::print() const
 {
-	printf("total %lu vertices, %lu edges\n", vv.size(), se.size());
+	printf("total %lu vertices, %lu edges\n", vv.size(), num_edges());
 	for(int i = 0; i < vv.size(); i++)
 	{
 		printf("vertex %d: ", i);
 		vv[i]->print();
 	}
 
-	for(edge_iterator it = se.begin(); it != se.end(); it++)
+	PEEI pe = edges();
+	for(edge_iterator it = pe.first; it != pe.second; it++)
 	{
 		(*it)->print();
 	}
@@ -8,6 +8,7 @@ See LICENSE for licensing.
 #define __GRAPH_BASE_H__
 
 #include <vector>
+#include <deque>
 #include <map>
 #include <string>
 
@@ -18,15 +19,15 @@ using namespace std;
 
 typedef map<int, string> MIS;
 typedef pair<int, string> PIS;
-typedef map<edge_descriptor, string> MES;
+typedef map<edge_descriptor, string, edge_compare> MES;
 typedef pair<edge_descriptor, string> PES;
-typedef map<edge_descriptor, bool> MEB;
-typedef map<edge_descriptor, double> MED;
+typedef map<edge_descriptor, bool, edge_compare> MEB;
+typedef map<edge_descriptor, double, edge_compare> MED;
 typedef pair<edge_descriptor, double> PED;
-typedef map<edge_descriptor, int> MEI;
+typedef map<edge_descriptor, int, edge_compare> MEI;
 typedef pair<edge_descriptor, int> PEI;
 typedef vector<edge_descriptor> VE;
-typedef set<edge_descriptor> SE;
+typedef set<edge_descriptor, edge_compare> SE;
 
 class graph_base
 {
@@ -37,11 +38,22 @@ public:
 
 protected:
 	vector<vertex_base*> vv;
-	set<edge_base*> se;
+	deque<edge_base> ep;		// edge pool, the edge with index k lives in ep[k]
+	mutable vector<edge_base*> se;	// all edges in order of creation, null for removed ones until compacted
+	mutable vector<int> ss;		// serial numbers of the entries in se
+	mutable int nd;				// number of removed edges still in se
+	vector<edge_base*> ve;		// edges by dense index, null if unused
+	vector<int> fe;				// unused indices in ve
+	int ns;						// serial number of the next edge
+
+	edge_base* insert_edge(int s, int t);
+	int erase_edge(edge_base *e);
+	int compact() const;
 
 public:
 	// modify the graph
 	virtual int copy(const graph_base &gr);
+	virtual int swap(graph_base &gr);
 	virtual int add_vertex();
 	virtual int clear_vertex(int v);
 	virtual int clear();
@@ -59,13 +71,15 @@ public:
 	virtual vector<edge_descriptor> edges(int x, int y);
 	virtual set<int> adjacent_vertices(int v);
 	virtual PEEI out_edges(int x) = 0;
-	virtual int get_edge_indices(VE &e2i, MEI &i2e);
+	virtual int get_edge_indices(VE &i2e, vector<int> &e2i);
+	virtual size_t num_edge_indices() const;
+	virtual edge_descriptor get_edge(int k) const;
 
 	// algorithms
 	virtual int bfs(int s, vector<int> &v);
 	virtual int bfs(int s, vector<int> &v, vector<int> &b);
-	virtual int bfs(int s, set<edge_descriptor> &ss);
-	virtual bool bfs(const vector<int> &vs, int t, const set<edge_descriptor> &fb);
+	virtual int bfs(int s, SE &ss);
+	virtual bool bfs(const vector<int> &vs, int t, const SE &fb);
 	virtual bool check_path(int s, int t);
 	virtual bool compute_shortest_path(int s, int t, vector<int> &p);
 	virtual bool check_nested();
@@ -10,6 +10,7 @@ See LICENSE for licensing.
 #include <cstdio>
 #include <cassert>
 #include <cstdio>
+#include <algorithm>
 
 using namespace std;
 
@@ -21,29 +22,33 @@ vertex_base::~vertex_base()
 
 int vertex_base::add_in_edge(edge_base *e)
 {
-	assert(si.find(e) == si.end());
-	si.insert(e);
+	vector<edge_base*>::iterator it = lower_bound(si.begin(), si.end(), e, edge_compare());
+	assert(it == si.end() || (*it) != e);
+	si.insert(it, e);
 	return 0;
 }
 
 int vertex_base::add_out_edge(edge_base *e)
 {
-	assert(so.find(e) == so.end());
-	so.insert(e);
+	vector<edge_base*>::iterator it = lower_bound(so.begin(), so.end(), e, edge_compare());
+	assert(it == so.end() || (*it) != e);
+	so.insert(it, e);
 	return 0;
 }
 
 int vertex_base::remove_in_edge(edge_base *e)
 {
-	assert(si.find(e) != si.end());
-	si.erase(e);
+	vector<edge_base*>::iterator it = lower_bound(si.begin(), si.end(), e, edge_compare());
+	assert(it != si.end() && (*it) == e);
+	si.erase(it);
 	return 0;
 }
 
 int vertex_base::remove_out_edge(edge_base *e)
 {
-	assert(so.find(e) != so.end());
-	so.erase(e);
+	vector<edge_base*>::iterator it = lower_bound(so.begin(), so.end(), e, edge_compare());
+	assert(it != so.end() && (*it) == e);
+	so.erase(it);
 	return 0;
 }
 
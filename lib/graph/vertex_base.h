@@ -7,7 +7,7 @@ See LICENSE for licensing.
 #ifndef __VERTEX_BASE_H__
 #define __VERTEX_BASE_H__
 
-#include <set>
+#include <vector>
 #include "edge_base.h"
 
 using namespace std;
@@ -19,8 +19,8 @@ public:
 	virtual ~vertex_base();
 
 protected:
-	set<edge_base*> si;		// in_edges
-	set<edge_base*> so;		// out_edges
+	vector<edge_base*> si;	// in_edges, in order of creation
+	vector<edge_base*> so;	// out_edges, in order of creation
 
 public:
 	virtual int add_in_edge(edge_base *e);
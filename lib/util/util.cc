@@ -5,6 +5,8 @@ See LICENSE for licensing.
 */
 
 #include "util.h"
+#include <sys/time.h>
+#include <sys/resource.h>
 
 vector<int> get_random_permutation(int n)
 {
@@ -20,4 +22,34 @@ vector<int> get_random_permutation(int n)
 	return v;
 }
 
+// sort pairs by their first (64-bit) value with a stable LSD radix sort
+int radix_sort(vector<PUI> &v)
+{
+	if(v.size() <= 1) return 0;
+	vector<PUI> w(v.size());
+	for(int b = 0; b < 64; b += 8)
+	{
+		int cnt[257] = {0};
+		for(int i = 0; i < v.size(); i++) cnt[((v[i].first >> b) & 0xff) + 1]++;
+		if(cnt[((v[0].first >> b) & 0xff) + 1] == v.size()) continue;
+		for(int k = 0; k < 256; k++) cnt[k + 1] += cnt[k];
+		for(int i = 0; i < v.size(); i++) w[cnt[(v[i].first >> b) & 0xff]++] = v[i];
+		v.swap(w);
+	}
+	return 0;
+}
 
+double get_wall_time()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+double get_peak_memory()
+{
+	// peak resident set size in MB (ru_maxrss is in KB on Linux)
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	return ru.ru_maxrss / 1024.0;
+}
@@ -30,6 +30,7 @@ typedef map<int32_t, int> MPI;
 typedef pair<int32_t, int> PPI;
 typedef pair<int, int> PI;
 typedef map<int, int> MI;
+typedef pair<uint64_t, int> PUI;
 
 // common small functions
 template<typename T>
@@ -169,5 +170,8 @@ vector<K> get_keys(const map<K, V> &m)
 }
 
 vector<int> get_random_permutation(int n);
+int radix_sort(vector<PUI> &v);
+double get_wall_time();
+double get_peak_memory();
 
 #endif
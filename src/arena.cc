@@ -0,0 +1,59 @@
+/*
+Part of Scallop Transcript Assembler
+(c) 2017 by  Mingfu Shao, Carl Kingsford, and Carnegie Mellon University.
+See LICENSE for licensing.
+*/
+
+#include <cstdlib>
+#include <algorithm>
+
+#include "arena.h"
+
+#define ARENA_CHUNK_SIZE 65536
+
+arena::arena()
+{
+	used = 0;
+	capacity = 0;
+}
+
+arena::~arena()
+{
+	clear();
+}
+
+char* arena::allocate(size_t n)
+{
+	if(n == 0) return NULL;
+
+	// keep 8-byte alignment
+	n = (n + 7) & ~((size_t)7);
+
+	if(used + n > capacity)
+	{
+		capacity = n > ARENA_CHUNK_SIZE ? n : ARENA_CHUNK_SIZE;
+		chunks.push_back((char*)malloc(capacity));
+		used = 0;
+	}
+
+	char *p = chunks.back() + used;
+	used += n;
+	return p;
+}
+
+int arena::swap(arena &a)
+{
+	chunks.swap(a.chunks);
+	std::swap(used, a.used);
+	std::swap(capacity, a.capacity);
+	return 0;
+}
+
+int arena::clear()
+{
+	for(int i = 0; i < chunks.size(); i++) free(chunks[i]);
+	chunks.clear();
+	used = 0;
+	capacity = 0;
+	return 0;
+}
@@ -0,0 +1,37 @@
+/*
+Part of Scallop Transcript Assembler
+(c) 2017 by  Mingfu Shao, Carl Kingsford, and Carnegie Mellon University.
+See LICENSE for licensing.
+*/
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+// chunked bump allocator; memory is only released all at once
+class arena
+{
+public:
+	arena();
+	~arena();
+
+private:
+	arena(const arena &a);
+	arena& operator=(const arena &a);
+
+private:
+	vector<char*> chunks;	// allocated chunks
+	size_t used;			// bytes used in the last chunk
+	size_t capacity;		// size of the last chunk
+
+public:
+	char* allocate(size_t n);
+	int swap(arena &a);
+	int clear();
+};
+
+#endif
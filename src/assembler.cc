@@ -5,8 +5,10 @@ See LICENSE for licensing.
 */
 
 #include <cstdio>
+#include <cstdlib>
 #include <cassert>
 #include <sstream>
+#include <algorithm>
 
 #include "config.h"
 #include "gtf.h"
@@ -20,125 +22,289 @@ See LICENSE for licensing.
 assembler::assembler()
 {
     sfn = sam_open(input_file.c_str(), "r");
+
+	tpool = NULL;
+	if(decode_threads >= 1)
+	{
+		// inflate bgzf blocks ahead of sam_read1
+		tpool = hts_tpool_init(decode_threads);
+		htsThreadPool p = {tpool, 0};
+		hts_set_thread_pool(sfn, &p);
+	}
+
     hdr = sam_hdr_read(sfn);
+	init();
+}
+
+assembler::assembler(previewer &pv)
+{
+	// continue reading from where the previewer stopped
+	sfn = pv.sfn;
+	hdr = pv.hdr;
+	tpool = pv.tpool;
+	phits.swap(pv.hits);
+	pdata.swap(pv.hdata);
+
+	pv.sfn = NULL;
+	pv.hdr = NULL;
+	pv.tpool = NULL;
+
+	init();
+}
+
+int assembler::init()
+{
     b1t = bam_init1();
+	idx = NULL;
 	index = 0;
 	terminate = false;
 	qlen = 0;
 	qcnt = 0;
+	decode_time = 0;
+	assembly_time = 0;
+	capped = 0;
+	dropped = 0;
+	quiet = false;
+	collected = 0;
+	finished = false;
+	ctid = -1;
+	scnt = 0;
+	spill = NULL;
+	return 0;
 }
 
 assembler::~assembler()
 {
+	if(idx != NULL) hts_idx_destroy(idx);
     bam_destroy1(b1t);
     bam_hdr_destroy(hdr);
     sam_close(sfn);
+	if(tpool != NULL) hts_tpool_destroy(tpool);
+	if(spill != NULL) fclose(spill);
+	for(int i = 0; i < retired.size(); i++) delete retired[i].second;
+	for(int i = 0; i < waits1.size(); i++) delete waits1[i];
+	for(int i = 0; i < waits2.size(); i++) delete waits2[i];
 }
 
 int assembler::assemble()
 {
-    while(sam_read1(sfn, hdr, b1t) >= 0)
+	// the detailed messages of verbose >= 2 come out of the assembly itself, keep them serial
+	if(region_parallel == true && num_threads >= 2 && fixed_gene_name == "" && input_file != "-" && verbose <= 1)
+	{
+		idx = sam_index_load(sfn, input_file.c_str());
+		if(idx == NULL) printf("index of %s is not available, assemble without region parallelism\n", input_file.c_str());
+		if(idx != NULL) return assemble_regions();
+	}
+
+	start_workers();
+
+	for(int i = 0; i < phits.size(); i++) add_hit(phits[i]);
+	vector<hit>().swap(phits);
+	pdata.clear();
+
+    while(read_record(NULL) >= 0)
 	{
 		if(terminate == true) return 0;
+		add_alignment();
+	}
 
-		bam1_core_t &p = b1t->core;
+	close_bundle(bb1);
+	close_bundle(bb2);
+	process();
 
-		if((p.flag & 0x4) >= 1) continue;										// read is not mapped
-		if((p.flag & 0x100) >= 1 && use_second_alignment == false) continue;	// secondary alignment
-		if(p.n_cigar > max_num_cigar) continue;									// ignore hits with more than max-num-cigar types
-		if(p.qual < min_mapping_quality) continue;								// ignore hits with small quality
-		if(p.n_cigar < 1) continue;												// should never happen
+	stop_workers();
 
-		hit ht(b1t);
-		ht.set_tags(b1t);
-		ht.set_strand();
-		ht.build_splice_positions();
+	finish();
+	return 0;
+}
+
+int assembler::read_record(hts_itr_t *itr)
+{
+	double t = get_wall_time();
+	int r = (itr == NULL) ? sam_read1(sfn, hdr, b1t) : sam_itr_next(sfn, itr, b1t);
+	decode_time += get_wall_time() - t;
+	return r;
+}
 
-		//ht.print();
+int assembler::add_alignment()
+{
+	bam1_core_t &p = b1t->core;
 
-		//if(ht.nh >= 2 && p.qual < min_mapping_quality) continue;
-		//if(ht.nm > max_edit_distance) continue;
+	if((p.flag & 0x4) >= 1) return 0;										// read is not mapped
+	if((p.flag & 0x100) >= 1 && use_second_alignment == false) return 0;	// secondary alignment
+	if(p.n_cigar > max_num_cigar) return 0;									// ignore hits with more than max-num-cigar types
+	if(p.qual < min_mapping_quality) return 0;								// ignore hits with small quality
+	if(p.n_cigar < 1) return 0;												// should never happen
 
-		qlen += ht.qlen;
-		qcnt += 1;
+	hit ht(b1t);
+	ht.set_tags(b1t);
+	return add_hit(ht);
+}
 
-		// truncate
-		if(ht.tid != bb1.tid || ht.pos > bb1.rpos + min_bundle_gap)
-		{
-			pool.push_back(bb1);
-			bb1.clear();
-		}
-		if(ht.tid != bb2.tid || ht.pos > bb2.rpos + min_bundle_gap)
-		{
-			pool.push_back(bb2);
-			bb2.clear();
-		}
+int assembler::add_hit(hit &ht)
+{
+	ht.set_strand();
+
+	//ht.print();
 
-		// process
-		process(batch_bundle_size);
+	//if(ht.nh >= 2 && p.qual < min_mapping_quality) return 0;
+	//if(ht.nm > max_edit_distance) return 0;
 
-		//printf("read strand = %c, xs = %c, ts = %c\n", ht.strand, ht.xs, ht.ts);
+	qlen += ht.qlen;
+	qcnt += 1;
 
-		// add hit
-		if(uniquely_mapped_only == true && ht.nh != 1) continue;
-		if(library_type != UNSTRANDED && ht.strand == '+' && ht.xs == '-') continue;
-		if(library_type != UNSTRANDED && ht.strand == '-' && ht.xs == '+') continue;
-		if(library_type != UNSTRANDED && ht.strand == '.' && ht.xs != '.') ht.strand = ht.xs;
-		if(library_type != UNSTRANDED && ht.strand == '+') bb1.add_hit(ht);
-		if(library_type != UNSTRANDED && ht.strand == '-') bb2.add_hit(ht);
-		if(library_type == UNSTRANDED && ht.xs == '.') bb1.add_hit(ht);
-		if(library_type == UNSTRANDED && ht.xs == '.') bb2.add_hit(ht);
-		if(library_type == UNSTRANDED && ht.xs == '+') bb1.add_hit(ht);
-		if(library_type == UNSTRANDED && ht.xs == '-') bb2.add_hit(ht);
+	// truncate
+	if(ht.tid != bb1.tid || ht.pos > bb1.rpos + min_bundle_gap)
+	{
+		close_bundle(bb1);
+	}
+	if(ht.tid != bb2.tid || ht.pos > bb2.rpos + min_bundle_gap)
+	{
+		close_bundle(bb2);
 	}
 
-	pool.push_back(bb1);
-	pool.push_back(bb2);
-	process(0);
+	// process
+	process();
 
-	assign_RPKM();
+	release_stores();
 
-	filter ft(trsts);
-	ft.merge_single_exon_transcripts();
-	trsts = ft.trs;
+	// all bundles of the previous chromosome are closed
+	if(ht.tid != ctid)
+	{
+		if(workers.size() >= 1) collect(0);
+		flush();
+		ctid = ht.tid;
+	}
 
-	write();
-	
+	//printf("read strand = %c, xs = %c, ts = %c\n", ht.strand, ht.xs, ht.ts);
+
+	// add hit
+	if(uniquely_mapped_only == true && ht.nh != 1) return 0;
+	if(library_type != UNSTRANDED && ht.strand == '+' && ht.xs == '-') return 0;
+	if(library_type != UNSTRANDED && ht.strand == '-' && ht.xs == '+') return 0;
+	if(library_type != UNSTRANDED && ht.strand == '.' && ht.xs != '.') ht.strand = ht.xs;
+
+	bool b1 = (library_type != UNSTRANDED) ? (ht.strand == '+') : (ht.xs == '.' || ht.xs == '+');
+	bool b2 = (library_type != UNSTRANDED) ? (ht.strand == '-') : (ht.xs == '.' || ht.xs == '-');
+
+	// decide under the depth cap first, so that left-out hits store nothing
+	int w1 = (b1 == true) ? bb1.sample(ht) : 0;
+	int w2 = (b2 == true) ? bb2.sample(ht) : 0;
+	if((b1 == true || b2 == true) && w1 <= 0 && w2 <= 0) dropped++;
+
+	// the data of a hit kept by both bundles is stored once, each bundle keeps its own copy of the hit
+	if(w1 >= 1 && w2 >= 1)
+	{
+		ht.attach(sdata);
+		scnt++;
+		bb1.add_shared_hit(ht, w1);
+		bb2.add_shared_hit(ht, w2);
+	}
+	else if(w1 >= 1) bb1.add_hit(ht, w1);
+	else if(w2 >= 1) bb2.add_hit(ht, w2);
+
+	return 0;
+}
+
+int assembler::close_bundle(bundle_base &bb)
+{
+	bool b = (bb.hits.size() >= 1);
+
+	// move bb into the pool, leaving it empty
+	pool.push_back(bundle_base());
+	pool.back().swap(bb);
+
+	// bb gets an index below this bound when it is processed
+	int bound = index + pool.size();
+
+	// old stores that only waited for bb can go once bb is assembled
+	vector<arena*> &w = (&bb == &bb1) ? waits1 : waits2;
+	for(int i = 0; i < w.size(); i++) retired.push_back(PIA(bound, w[i]));
+	w.clear();
+
+	// the other bundle may still refer to sdata, then it waits for that one
+	if(b == false || scnt <= 0) return 0;
+	if(&bb == &bb1) retire_store(bound, waits2, bb2.hits.size() >= 1);
+	else retire_store(bound, waits1, bb1.hits.size() >= 1);
+	return 0;
+}
+
+int assembler::retire_store(int bound, vector<arena*> &waits, bool open)
+{
+	arena *a = new arena();
+	a->swap(sdata);
+	if(open == true) waits.push_back(a);
+	else retired.push_back(PIA(bound, a));
+	scnt = 0;
 	return 0;
 }
 
-int assembler::process(int n)
+int assembler::release_stores()
 {
-	if(pool.size() < n) return 0;
+	// without workers every bundle is assembled as soon as it is processed
+	int done = (workers.size() >= 1) ? collected : index;
+	while(retired.size() >= 1 && retired.front().first <= done)
+	{
+		delete retired.front().second;
+		retired.pop_front();
+	}
+	return 0;
+}
 
+int assembler::process()
+{
 	for(int i = 0; i < pool.size(); i++)
 	{
 		bundle_base &bb = pool[i];
 
 		//printf("bundle %d has %lu reads\n", i, bb.hits.size());
 
+		if(bb.dropped >= 1) capped++;
+
 		if(bb.hits.size() < min_num_hits_in_bundle) continue;
 		if(bb.tid < 0) continue;
 
 		char buf[1024];
 		strcpy(buf, hdr->target_name[bb.tid]);
+		bb.chrm = string(buf);
 
-		bundle bd(bb);
-
-		bd.chrm = string(buf);
-		bd.build();
-		bd.print(index);
-
-		//if(verbose >= 1) bd.print(index);
+		if(workers.size() >= 1)
+		{
+			dispatch(bb, index);
+		}
+		else
+		{
+			// region workers cannot tell the final bundle index, so they stay quiet
+			string s;
+			double t = get_wall_time();
+			assemble(bb, index, trsts, quiet ? &s : NULL);
+			assembly_time += get_wall_time() - t;
+		}
 
-		assemble(bd.gr, bd.hs);
 		index++;
 	}
 	pool.clear();
+
+	// keep a bounded number of bundles in flight
+	if(workers.size() >= 1) collect(2 * workers.size());
+
+	return 0;
+}
+
+int assembler::assemble(bundle_base &bb, int id, vector<transcript> &vt, string *log)
+{
+	bundle bd(bb);
+	bd.build();
+
+	// on worker threads messages are kept in log and printed in bundle order
+	if(log == NULL) bd.print(id);
+	else bd.summarize(id, *log);
+
+	assemble(bd.gr, bd.hs, id, vt, log);
 	return 0;
 }
 
-int assembler::assemble(const splice_graph &gr0, const hyper_set &hs0)
+int assembler::assemble(const splice_graph &gr0, const hyper_set &hs0, int id, vector<transcript> &vt, string *log)
 {
 	super_graph sg(gr0, hs0);
 	sg.build();
@@ -146,7 +312,7 @@ int assembler::assemble(const splice_graph &gr0, const hyper_set &hs0)
 	vector<transcript> gv;
 	for(int k = 0; k < sg.subs.size(); k++)
 	{
-		string gid = "gene." + tostring(index) + "." + tostring(k);
+		string gid = "gene." + tostring(id) + "." + tostring(k);
 		if(fixed_gene_name != "" && gid != fixed_gene_name) continue;
 
 		if(verbose >= 2 && (k == 0 || fixed_gene_name != "")) sg.print();
@@ -154,8 +320,13 @@ int assembler::assemble(const splice_graph &gr0, const hyper_set &hs0)
 		splice_graph &gr = sg.subs[k];
 		hyper_set &hs = sg.hss[k];
 
+		// the sub-graph is not used afterwards, so move it into scallop
 		gr.gid = gid;
-		scallop sc(gr, hs);
+		scallop sc;
+		sc.log = log;
+		sc.gr.swap(gr);
+		sc.hs.swap(hs);
+		sc.init();
 		sc.assemble();
 
 		if(verbose >= 2)
@@ -181,8 +352,319 @@ int assembler::assemble(const splice_graph &gr0, const hyper_set &hs0)
 
 	filter ft(gv);
 	ft.remove_nested_transcripts();
-	if(ft.trs.size() >= 1) trsts.insert(trsts.end(), ft.trs.begin(), ft.trs.end());
+	if(ft.trs.size() >= 1) vt.insert(vt.end(), ft.trs.begin(), ft.trs.end());
+
+	return 0;
+}
+
+int assembler::start_workers()
+{
+	// the gene-fixing mode relies on the serial order to terminate early,
+	// and the detailed messages of verbose >= 2 cannot be kept per bundle
+	if(num_threads <= 1 || fixed_gene_name != "" || verbose >= 2) return 0;
+
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&job_ready, NULL);
+	pthread_cond_init(&job_done, NULL);
+
+	workers.resize(num_threads);
+	for(int i = 0; i < workers.size(); i++)
+	{
+		pthread_create(&workers[i], NULL, run_worker, this);
+	}
+	return 0;
+}
+
+int assembler::stop_workers()
+{
+	if(workers.size() == 0) return 0;
+
+	pthread_mutex_lock(&mutex);
+	finished = true;
+	pthread_cond_broadcast(&job_ready);
+	pthread_mutex_unlock(&mutex);
+
+	for(int i = 0; i < workers.size(); i++)
+	{
+		pthread_join(workers[i], NULL);
+	}
+
+	collect(0);
+	workers.clear();
+
+	pthread_cond_destroy(&job_done);
+	pthread_cond_destroy(&job_ready);
+	pthread_mutex_destroy(&mutex);
+	return 0;
+}
 
+int assembler::dispatch(bundle_base &bb, int id)
+{
+	pthread_mutex_lock(&mutex);
+	jobs.push_back(bundle_base());
+	jobs.back().swap(bb);
+	jobids.push_back(id);
+	pthread_cond_signal(&job_ready);
+	pthread_mutex_unlock(&mutex);
+	return 0;
+}
+
+int assembler::collect(int n)
+{
+	// append results in bundle order until at most n bundles are in flight
+	pthread_mutex_lock(&mutex);
+	while(true)
+	{
+		map<int, vector<transcript> >::iterator it = results.find(collected);
+		if(it != results.end())
+		{
+			printf("%s", logs[collected].c_str());
+			logs.erase(collected);
+			trsts.insert(trsts.end(), it->second.begin(), it->second.end());
+			results.erase(it);
+			collected++;
+			continue;
+		}
+		if(index - collected <= n) break;
+		pthread_cond_wait(&job_done, &mutex);
+	}
+	pthread_mutex_unlock(&mutex);
+	return 0;
+}
+
+int assembler::work()
+{
+	while(true)
+	{
+		pthread_mutex_lock(&mutex);
+		while(jobs.size() == 0 && finished == false) pthread_cond_wait(&job_ready, &mutex);
+		if(jobs.size() == 0)
+		{
+			pthread_mutex_unlock(&mutex);
+			break;
+		}
+		bundle_base bb;
+		bb.swap(jobs.front());
+		int id = jobids.front();
+		jobs.pop_front();
+		jobids.pop_front();
+		pthread_mutex_unlock(&mutex);
+
+		vector<transcript> vt;
+		string s;
+		double t = get_wall_time();
+		assemble(bb, id, vt, &s);
+		t = get_wall_time() - t;
+
+		pthread_mutex_lock(&mutex);
+		assembly_time += t;
+		results[id].swap(vt);
+		logs[id].swap(s);
+		pthread_cond_signal(&job_done);
+		pthread_mutex_unlock(&mutex);
+	}
+	return 0;
+}
+
+void* assembler::run_worker(void *p)
+{
+	assembler *asmb = (assembler*)(p);
+	asmb->work();
+	return NULL;
+}
+
+int assembler::assemble_regions()
+{
+	// contigs with more mapped reads are assembled first for load balance
+	vector< pair<int64_t, int> > v;
+	for(int tid = 0; tid < hdr->n_targets; tid++)
+	{
+		uint64_t mapped = 0, unmapped = 0;
+		if(hts_idx_get_stat(idx, tid, &mapped, &unmapped) < 0) mapped = hdr->target_len[tid];
+		if(mapped <= 0) continue;
+		v.push_back(pair<int64_t, int>(0 - (int64_t)(mapped), tid));
+	}
+	sort(v.begin(), v.end());
+
+	regions.clear();
+	for(int i = 0; i < v.size(); i++) regions.push_back(v[i].second);
+
+	next_region = 0;
+	rtrsts.assign(hdr->n_targets, vector<transcript>());
+	rbundles.assign(hdr->n_targets, 0);
+	rqlen.assign(hdr->n_targets, 0);
+	rqcnt.assign(hdr->n_targets, 0);
+
+	pthread_mutex_init(&mutex, NULL);
+
+	int n = num_threads < regions.size() ? num_threads : regions.size();
+	workers.resize(n);
+	for(int i = 0; i < workers.size(); i++)
+	{
+		pthread_create(&workers[i], NULL, run_region_worker, this);
+	}
+	for(int i = 0; i < workers.size(); i++)
+	{
+		pthread_join(workers[i], NULL);
+	}
+	workers.clear();
+
+	pthread_mutex_destroy(&mutex);
+
+	// workers without an index take no contig; fail if none of them had one
+	if(next_region < regions.size())
+	{
+		printf("error: fail to load the index of %s in any thread.\n", input_file.c_str());
+		exit(0);
+	}
+
+	// merge contigs in the order of the input, with bundles renumbered
+	for(int tid = 0; tid < hdr->n_targets; tid++)
+	{
+		renumber(rtrsts[tid], index);
+		trsts.insert(trsts.end(), rtrsts[tid].begin(), rtrsts[tid].end());
+		index += rbundles[tid];
+		qlen += rqlen[tid];
+		qcnt += rqcnt[tid];
+	}
+	rtrsts.clear();
+
+	finish();
+	return 0;
+}
+
+int assembler::assemble_region(int tid)
+{
+	index = 0;
+	qlen = 0;
+	qcnt = 0;
+	trsts.clear();
+
+	hts_itr_t *itr = sam_itr_queryi(idx, tid, 0, hdr->target_len[tid]);
+	while(read_record(itr) >= 0)
+	{
+		add_alignment();
+	}
+	hts_itr_destroy(itr);
+
+	close_bundle(bb1);
+	close_bundle(bb2);
+	process();
+
+	// every bundle of the region is assembled
+	for(int i = 0; i < retired.size(); i++) delete retired[i].second;
+	retired.clear();
+
+	bb1.clear();
+	bb2.clear();
+	return 0;
+}
+
+int assembler::work_regions()
+{
+	// each worker reads the input through its own file handle and index
+	assembler asmb;
+	asmb.quiet = true;
+	asmb.idx = sam_index_load(asmb.sfn, input_file.c_str());
+	if(asmb.idx == NULL)
+	{
+		// leave the contigs to the other workers
+		printf("index of %s is not available in a worker thread\n", input_file.c_str());
+		return 0;
+	}
+
+	while(true)
+	{
+		pthread_mutex_lock(&mutex);
+		int k = next_region++;
+		pthread_mutex_unlock(&mutex);
+
+		if(k >= regions.size()) break;
+
+		int tid = regions[k];
+		asmb.assemble_region(tid);
+
+		rtrsts[tid].swap(asmb.trsts);
+		rbundles[tid] = asmb.index;
+		rqlen[tid] = asmb.qlen;
+		rqcnt[tid] = asmb.qcnt;
+	}
+
+	pthread_mutex_lock(&mutex);
+	decode_time += asmb.decode_time;
+	assembly_time += asmb.assembly_time;
+	capped += asmb.capped;
+	dropped += asmb.dropped;
+	pthread_mutex_unlock(&mutex);
+	return 0;
+}
+
+void* assembler::run_region_worker(void *p)
+{
+	assembler *asmb = (assembler*)(p);
+	asmb->work_regions();
+	return NULL;
+}
+
+int assembler::renumber(vector<transcript> &vt, int offset)
+{
+	// shift the bundle index in "gene.<index>.<k>[.<j>]"
+	if(offset == 0) return 0;
+	for(int i = 0; i < vt.size(); i++)
+	{
+		string &g = vt[i].gene_id;
+		string &t = vt[i].transcript_id;
+		size_t p = g.find('.', 5);
+		assert(g.substr(0, 5) == "gene." && p != string::npos);
+		assert(t.compare(0, p, g, 0, p) == 0);
+		string s = "gene." + tostring(atoi(g.c_str() + 5) + offset);
+		g = s + g.substr(p);
+		t = s + t.substr(p);
+	}
+	return 0;
+}
+
+int assembler::finish()
+{
+	if(verbose >= 1) printf("time: decoding records = %.2lf seconds, assembling bundles = %.2lf seconds (summed over threads)\n", decode_time, assembly_time);
+	if(verbose >= 1) printf("memory: peak resident set size = %.1lf MB\n", get_peak_memory());
+	if(verbose >= 1 && max_bundle_depth >= 1) printf("depth cap: %d bundles subsampled, %ld hits left out\n", capped, dropped);
+
+	flush();
+	write();
+	return 0;
+}
+
+int assembler::flush()
+{
+	if(trsts.size() == 0) return 0;
+
+	filter ft(trsts);
+	ft.merge_single_exon_transcripts();
+	trsts.clear();
+
+	// RPKM depends on all reads, so transcripts are kept in spill until written;
+	// it is created here since region workers never use it
+	if(spill == NULL) spill = tmpfile();
+	if(spill == NULL)
+	{
+		printf("error: fail to create a temporary file.\n");
+		exit(0);
+	}
+	if(fseek(spill, 0, SEEK_END) != 0) spill_error();
+	for(int i = 0; i < ft.trs.size(); i++)
+	{
+		const transcript &t = ft.trs[i];
+		if(i == 0 || t.seqname != ft.trs[i - 1].seqname)
+		{
+			long p = ftell(spill);
+			if(p < 0) spill_error();
+			blocks.push_back(PSLI(t.seqname, PLI(p, 0)));
+		}
+		blocks.back().second.second++;
+		write_transcript(t);
+	}
+	if(fflush(spill) != 0) spill_error();
 	return 0;
 }
 
@@ -200,15 +682,84 @@ int assembler::write()
 {
 	ofstream fout(output_file.c_str());
 	if(fout.fail()) return 0;
-	for(int i = 0; i < trsts.size(); i++)
+
+	// chromosomes are written in the order of their names
+	stable_sort(blocks.begin(), blocks.end(), compare_block);
+	for(int k = 0; k < blocks.size(); k++)
 	{
-		transcript &t = trsts[i];
-		t.write(fout);
+		if(fseek(spill, blocks[k].second.first, SEEK_SET) != 0) spill_error();
+		trsts.resize(blocks[k].second.second);
+		for(int i = 0; i < trsts.size(); i++) read_transcript(trsts[i]);
+
+		assign_RPKM();
+
+		for(int i = 0; i < trsts.size(); i++)
+		{
+			transcript &t = trsts[i];
+			t.write(fout);
+		}
 	}
+	trsts.clear();
+
 	fout.close();
 	return 0;
 }
 
+int assembler::write_transcript(const transcript &t)
+{
+	bool b = true;
+	const string *v[] = {&t.seqname, &t.source, &t.gene_id, &t.transcript_id, &t.gene_type, &t.transcript_type};
+	for(int k = 0; k < 6; k++)
+	{
+		int n = v[k]->size();
+		if(fwrite(&n, sizeof(int), 1, spill) != 1) b = false;
+		if(n >= 1 && fwrite(v[k]->data(), 1, n, spill) != n) b = false;
+	}
+	if(fwrite(&t.strand, sizeof(char), 1, spill) != 1) b = false;
+	if(fwrite(&t.coverage, sizeof(double), 1, spill) != 1) b = false;
+	if(fwrite(&t.covratio, sizeof(double), 1, spill) != 1) b = false;
+	int n = t.exons.size();
+	if(fwrite(&n, sizeof(int), 1, spill) != 1) b = false;
+	if(n >= 1 && fwrite(&t.exons[0], sizeof(PI32), n, spill) != n) b = false;
+
+	if(b == false) spill_error();
+	return 0;
+}
+
+int assembler::read_transcript(transcript &t)
+{
+	vector<char> buf;
+	string *v[] = {&t.seqname, &t.source, &t.gene_id, &t.transcript_id, &t.gene_type, &t.transcript_type};
+	for(int k = 0; k < 6; k++)
+	{
+		int n = 0;
+		if(fread(&n, sizeof(int), 1, spill) != 1 || n < 0) spill_error();
+		buf.resize(n);
+		if(n >= 1 && fread(&buf[0], 1, n, spill) != n) spill_error();
+		v[k]->assign(buf.begin(), buf.end());
+	}
+
+	int n = 0;
+	bool b = true;
+	if(fread(&t.strand, sizeof(char), 1, spill) != 1) b = false;
+	if(fread(&t.coverage, sizeof(double), 1, spill) != 1) b = false;
+	if(fread(&t.covratio, sizeof(double), 1, spill) != 1) b = false;
+	if(fread(&n, sizeof(int), 1, spill) != 1 || n < 0) b = false;
+	if(b == false) spill_error();
+
+	t.exons.resize(n);
+	if(n >= 1 && fread(&t.exons[0], sizeof(PI32), n, spill) != n) spill_error();
+	return 0;
+}
+
+int assembler::spill_error()
+{
+	// a partly written or read spill would give a corrupt output file
+	printf("error: fail to write or read transcripts in a temporary file.\n");
+	exit(0);
+	return 0;
+}
+
 int assembler::compare(splice_graph &gr, const string &file, const string &texfile)
 {
 	if(file == "") return 0;
@@ -226,3 +777,8 @@ int assembler::compare(splice_graph &gr, const string &file, const string &texfi
 
 	return 0;
 }
+
+bool compare_block(const PSLI &x, const PSLI &y)
+{
+	return x.first < y.first;
+}
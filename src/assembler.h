@@ -9,42 +9,117 @@ See LICENSE for licensing.
 
 #include <fstream>
 #include <string>
+#include <deque>
+#include <map>
+#include <pthread.h>
+#include "htslib/thread_pool.h"
 #include "bundle_base.h"
 #include "bundle.h"
+#include "previewer.h"
 #include "transcript.h"
 #include "splice_graph.h"
 
 using namespace std;
 
+typedef pair<long, int> PLI;
+typedef pair<string, PLI> PSLI;
+typedef pair<int, arena*> PIA;
+
 class assembler
 {
 public:
 	assembler();
+	assembler(previewer &pv);
 	~assembler();
 
 private:
 	samFile *sfn;
 	bam_hdr_t *hdr;
+	hts_idx_t *idx;
+	hts_tpool *tpool;
 	bam1_t *b1t;
+	vector<hit> phits;		// hits already read by the previewer
+	arena pdata;			// data of phits
 	bundle_base bb1;		// +
 	bundle_base bb2;		// -
-	vector<bundle_base> pool;
+	deque<bundle_base> pool;
+	arena sdata;							// data of unstranded hits, shared by bb1 and bb2
+	int scnt;								// number of hits stored in sdata
+	vector<arena*> waits1;					// old sdata that the open bb1 still refers to
+	vector<arena*> waits2;					// old sdata that the open bb2 still refers to
+	deque<PIA> retired;						// old sdata and the number of bundles that may refer to it
 
 	int index;
 	bool terminate;
 	int qcnt;
 	double qlen;
 	vector<transcript> trsts;
+	int32_t ctid;							// chromosome of the last hit
+	FILE *spill;							// transcripts of finished chromosomes
+	vector<PSLI> blocks;					// chromosome, offset and number of transcripts in spill
+	double decode_time;						// time spent in reading records
+	double assembly_time;					// time spent in assembling bundles, summed over threads
+	int capped;								// number of bundles subsampled by the depth cap
+	int64_t dropped;						// number of hits left out by the depth cap
+	bool quiet;								// do not print messages of each bundle
+
+	// for multi-threading
+	vector<pthread_t> workers;				// worker threads
+	pthread_mutex_t mutex;					// guards everything below
+	pthread_cond_t job_ready;				// a job is queued or input is finished
+	pthread_cond_t job_done;				// a worker has stored a result
+	deque<bundle_base> jobs;				// closed bundles waiting for a worker
+	deque<int> jobids;						// bundle index of each job
+	map<int, vector<transcript> > results;	// assembled bundles waiting to be collected
+	map<int, string> logs;					// messages of the bundles in results
+	int collected;							// index of the next bundle to be collected
+	bool finished;							// no more jobs will be queued
+
+	// for region-parallel mode
+	vector<int> regions;					// contigs to be assembled, larger ones first
+	int next_region;						// index of the next contig in regions
+	vector< vector<transcript> > rtrsts;	// transcripts of each contig
+	vector<int> rbundles;					// number of bundles of each contig
+	vector<double> rqlen;					// total query length of each contig
+	vector<int> rqcnt;						// number of reads of each contig
 
 public:
 	int assemble();
 
 private:
-	int process(int n);
-	int assemble(const splice_graph &gr, const hyper_set &hs);
+	int init();
+	int read_record(hts_itr_t *itr);
+	int add_alignment();
+	int add_hit(hit &ht);
+	int close_bundle(bundle_base &bb);
+	int retire_store(int bound, vector<arena*> &waits, bool open);
+	int release_stores();
+	int process();
+	int assemble(const splice_graph &gr, const hyper_set &hs, int id, vector<transcript> &vt, string *log);
+	int assemble(bundle_base &bb, int id, vector<transcript> &vt, string *log);
+
+	int start_workers();
+	int stop_workers();
+	int dispatch(bundle_base &bb, int id);
+	int collect(int n);
+	int work();
+	static void* run_worker(void *p);
+
+	int assemble_regions();
+	int assemble_region(int tid);
+	int work_regions();
+	int renumber(vector<transcript> &vt, int offset);
+	static void* run_region_worker(void *p);
+	int finish();
+	int flush();
 	int assign_RPKM();
 	int write();
+	int write_transcript(const transcript &t);
+	int read_transcript(transcript &t);
+	int spill_error();
 	int compare(splice_graph &gr, const string &ref, const string &tex = "");
 };
 
+bool compare_block(const PSLI &x, const PSLI &y);
+
 #endif
@@ -6,7 +6,9 @@ See LICENSE for licensing.
 
 #include <cassert>
 #include <cstdio>
+#include <cstring>
 #include <map>
+#include <algorithm>
 #include <iomanip>
 #include <fstream>
 
@@ -16,9 +18,11 @@ See LICENSE for licensing.
 #include "util.h"
 #include "undirected_graph.h"
 
-bundle::bundle(const bundle_base &bb)
-	: bundle_base(bb)
+bundle::bundle(bundle_base &bb)
 {
+	swap(bb);
+	bridge_hits = 0;
+	bridge_misses = 0;
 }
 
 bundle::~bundle()
@@ -26,12 +30,15 @@ bundle::~bundle()
 
 int bundle::build()
 {
+	if(collapse_duplicates == true) collapse();
+	build_maps();
 	compute_strand();
 
 	check_left_ascending();
 
 	build_junctions();
 	//correct_junctions();
+	mindex.build(mmap);
 
 	build_regions();
 	build_partial_exons();
@@ -55,9 +62,9 @@ int bundle::compute_strand()
 	int n0 = 0, np = 0, nq = 0;
 	for(int i = 0; i < hits.size(); i++)
 	{
-		if(hits[i].xs == '.') n0++;
-		if(hits[i].xs == '+') np++;
-		if(hits[i].xs == '-') nq++;
+		if(hits[i].xs == '.') n0 += hits[i].weight;
+		if(hits[i].xs == '+') np += hits[i].weight;
+		if(hits[i].xs == '-') nq += hits[i].weight;
 	}
 
 	if(np > nq) strand = '+';
@@ -91,82 +98,44 @@ int bundle::check_right_ascending()
 
 int bundle::build_junctions()
 {
-	int min_max_boundary_quality = min_mapping_quality;
-	map< int64_t, vector<int> > m;
+	// one (splice position, hit) pair for each splice position of each hit;
+	// positions are pack()ed non-negative coordinates, so sort as unsigned
+	vector<PUI> v;
 	for(int i = 0; i < hits.size(); i++)
 	{
-		vector<int64_t> v = hits[i].spos;
-		if(v.size() == 0) continue;
-
-		//hits[i].print();
-		for(int k = 0; k < v.size(); k++)
-		{
-			int64_t p = v[k];
-
-			// DEBUG
-			/*
-			int32_t x1 = low32(p);
-			int32_t x2 = high32(p);
-			if(fabs(x1 - 9364768) <= 2 || fabs(x2 - 9364768) <=2)
-			{
-				printf("HIT ");
-				hits[i].print();
-			}
-			*/
-			if(m.find(p) == m.end())
-			{
-				vector<int> hv;
-				hv.push_back(i);
-				m.insert(pair< int64_t, vector<int> >(p, hv));
-			}
-			else
-			{
-				m[p].push_back(i);
-			}
-		}
+		const hit &h = hits[i];
+		for(int k = 0; k < h.n_spos; k++) v.push_back(PUI(h.spos[k], i));
 	}
+	radix_sort(v);
 
-	map< int64_t, vector<int> >::iterator it;
-	for(it = m.begin(); it != m.end(); it++)
+	for(int i = 0, j = 0; i < v.size(); i = j)
 	{
-		vector<int> &v = it->second;
-		if(v.size() < min_splice_boundary_hits) continue;
-
-		int32_t p1 = high32(it->first);
-		int32_t p2 = low32(it->first);
-
+		int n = 0;
 		int s0 = 0;
 		int s1 = 0;
 		int s2 = 0;
 		int nm = 0;
-		for(int k = 0; k < v.size(); k++)
+		for(j = i; j < v.size() && v[j].first == v[i].first; j++)
 		{
-			hit &h = hits[v[k]];
-			nm += h.nm;
-			if(h.xs == '.') s0++;
-			if(h.xs == '+') s1++;
-			if(h.xs == '-') s2++;
+			const hit &h = hits[v[j].second];
+			n += h.weight;
+			nm += h.nm * h.weight;
+			if(h.xs == '.') s0 += h.weight;
+			if(h.xs == '+') s1 += h.weight;
+			if(h.xs == '-') s2 += h.weight;
 		}
 
-		//printf("junction: %s:%d-%d (%d, %d, %d) %d\n", chrm.c_str(), p1, p2, s0, s1, s2, s1 < s2 ? s1 : s2);
+		if(n < min_splice_boundary_hits) continue;
 
-		junction jc(it->first, v.size());
+		//printf("junction: %s:%d-%d (%d, %d, %d) %d\n", chrm.c_str(), high32(v[i].first), low32(v[i].first), s0, s1, s2, s1 < s2 ? s1 : s2);
+
+		junction jc(v[i].first, n);
 		jc.nm = nm;
 		if(s1 == 0 && s2 == 0) jc.strand = '.';
 		else if(s1 >= 1 && s2 >= 1) jc.strand = '.';
 		else if(s1 > s2) jc.strand = '+';
 		else jc.strand = '-';
 		junctions.push_back(jc);
-
-		/*
-		uint32_t max_qual = 0;
-		for(int k = 0; k < v.size(); k++)
-		{
-			hit &h = hits[v[k]];
-			if(h.qual > max_qual) max_qual = h.qual;
-		}
-		assert(max_qual >= min_max_boundary_quality);
-		*/
 	}
 	return 0;
 }
@@ -245,7 +214,7 @@ int bundle::build_regions()
 		junction &jc = junctions[i];
 
 		double ave, dev;
-		evaluate_rectangle(mmap, jc.lpos, jc.rpos, ave, dev);
+		mindex.evaluate_rectangle(jc.lpos, jc.rpos, ave, dev);
 
 		int32_t l = jc.lpos;
 		int32_t r = jc.rpos;
@@ -278,7 +247,7 @@ int bundle::build_regions()
 		if(ltype == LEFT_RIGHT_SPLICE) ltype = RIGHT_SPLICE;
 		if(rtype == LEFT_RIGHT_SPLICE) rtype = LEFT_SPLICE;
 
-		regions.push_back(region(l, r, ltype, rtype, &mmap, &imap));
+		regions.push_back(region(l, r, ltype, rtype, &mmap, &imap, &mindex));
 	}
 
 	return 0;
@@ -297,25 +266,41 @@ int bundle::build_partial_exons()
 
 int bundle::build_partial_exon_map()
 {
-	pmap.clear();
+	// partial exons are sorted and do not overlap
+	plpos.resize(pexons.size());
+	prpos.resize(pexons.size());
 	for(int i = 0; i < pexons.size(); i++)
 	{
-		partial_exon &p = pexons[i];
-		pmap += make_pair(ROI(p.lpos, p.rpos), i + 1);
+		plpos[i] = pexons[i].lpos;
+		prpos[i] = pexons[i].rpos;
+		assert(i == 0 || prpos[i - 1] <= plpos[i]);
 	}
 	return 0;
 }
 
+// index of the last element of v that is <= x, or -1; the loop has no
+// data-dependent branch, so its length only depends on the size of v
+static int locate_last_not_greater(const vector<int32_t> &v, int32_t x)
+{
+	if(v.size() == 0) return -1;
+	const int32_t *p = &v[0];
+	int n = v.size();
+	while(n > 1)
+	{
+		int h = n / 2;
+		p = (p[h] <= x) ? p + h : p;
+		n -= h;
+	}
+	return (p - &v[0]) - (*p > x ? 1 : 0);
+}
+
 int bundle::locate_left_partial_exon(int32_t x)
 {
-	SIMI it = pmap.find(ROI(x, x + 1));
-	if(it == pmap.end()) return -1;
-	assert(it->second >= 1);
-	assert(it->second <= pexons.size());
-
-	int k = it->second - 1;
-	int32_t p1 = lower(it->first);
-	int32_t p2 = upper(it->first);
+	int k = locate_last_not_greater(plpos, x);
+	if(k < 0 || prpos[k] <= x) return -1;
+
+	int32_t p1 = plpos[k];
+	int32_t p2 = prpos[k];
 	assert(p2 >= x);
 	assert(p1 <= x);
 
@@ -327,14 +312,11 @@ int bundle::locate_left_partial_exon(int32_t x)
 
 int bundle::locate_right_partial_exon(int32_t x)
 {
-	SIMI it = pmap.find(ROI(x - 1, x));
-	if(it == pmap.end()) return -1;
-	assert(it->second >= 1);
-	assert(it->second <= pexons.size());
-
-	int k = it->second - 1;
-	int32_t p1 = lower(it->first);
-	int32_t p2 = upper(it->first);
+	int k = locate_last_not_greater(plpos, x - 1);
+	if(k < 0 || prpos[k] <= x - 1) return -1;
+
+	int32_t p1 = plpos[k];
+	int32_t p2 = prpos[k];
 	assert(p1 < x);
 	assert(p2 >= x);
 
@@ -342,6 +324,27 @@ int bundle::locate_right_partial_exon(int32_t x)
 	return k;
 }
 
+int bundle::locate_partial_exons(const hit &h, vector<int> &v)
+{
+	// append the partial exons covered by each matched block of h,
+	// reading the blocks from the cigar directly
+	int32_t p = h.pos;
+	for(int k = 0; k < h.n_cigar; k++)
+	{
+		int op = bam_cigar_op(h.cigar[k]);
+		int32_t len = bam_cigar_oplen(h.cigar[k]);
+		if(bam_cigar_type(op) & 2) p += len;
+		if(op != BAM_CMATCH) continue;
+
+		int k1 = locate_left_partial_exon(p - len);
+		int k2 = locate_right_partial_exon(p);
+		if(k1 < 0 || k2 < 0) continue;
+
+		for(int j = k1; j <= k2; j++) v.push_back(j);
+	}
+	return 0;
+}
+
 int bundle::build_hyper_edges1()
 {
 	hs.clear();
@@ -350,34 +353,41 @@ int bundle::build_hyper_edges1()
 		hit &h = hits[i];
 		if((h.flag & 0x4) >= 1) continue;
 
-		vector<int64_t> v;
-		h.get_matched_intervals(v);
-		if(v.size() == 0) continue;
-
-		set<int> sp;
-		for(int k = 0; k < v.size(); k++)
-		{
-			int32_t p1 = high32(v[k]);
-			int32_t p2 = low32(v[k]);
-
-			int k1 = locate_left_partial_exon(p1);
-			int k2 = locate_right_partial_exon(p2);
-			if(k1 < 0 || k2 < 0) continue;
-
-			for(int j = k1; j <= k2; j++) sp.insert(j);
-		}
+		vector<int> v;
+		locate_partial_exons(h, v);
 
-		if(sp.size() <= 1) continue;
-		hs.add_node_list(sp);
+		add_hyper_edge(v, h.weight);
 	}
 
 	return 0;
 }
 
+int bundle::add_hyper_edge(vector<int> &v, int w)
+{
+	// sort and merge in place rather than building a set for each read
+	sort(v.begin(), v.end());
+	v.erase(unique(v.begin(), v.end()), v.end());
+	if(v.size() >= 2) hs.add_node_list(v, w);
+	return 0;
+}
+
 int bundle::build_hyper_edges2()
 {
-	//sort(hits.begin(), hits.end(), hit_compare_by_name);
-	sort(hits.begin(), hits.end());
+	vector<int> order;
+	group_by_name(hits, order);
+
+	// the alignments of the last read are not flushed below; as with
+	// sorting by name, make it the read with the greatest name
+	int b1 = 0, b2 = 0;
+	for(int i = 0, j = 0; i < order.size(); i = j)
+	{
+		const char *q = hits[order[i]].qname;
+		for(j = i + 1; j < order.size() && strcmp(hits[order[j]].qname, q) == 0; j++);
+		if(strcmp(q, hits[order[b1]].qname) < 0) continue;
+		b1 = i;
+		b2 = j;
+	}
+	rotate(order.begin() + b1, order.begin() + b2, order.end());
 
 	/*
 	printf("----------------------\n");
@@ -386,13 +396,16 @@ int bundle::build_hyper_edges2()
 	*/
 
 	hs.clear();
+	bridges.clear();
 
-	string qname;
+	const char *qname = NULL;
+	uint64_t qhash = 0;
 	int hi = -2;
+	int w = 0;		// weight of the hits in sp1, the largest if they differ
 	vector<int> sp1;
-	for(int i = 0; i < hits.size(); i++)
+	for(int i = 0; i < order.size(); i++)
 	{
-		hit &h = hits[i];
+		hit &h = hits[order[i]];
 		
 		/*
 		printf("sp1 = ( ");
@@ -401,37 +414,26 @@ int bundle::build_hyper_edges2()
 		h.print();
 		*/
 
-		if(h.qname != qname || h.hi != hi)
+		if(qname == NULL || h.qhash != qhash || h.hi != hi || strcmp(h.qname, qname) != 0)
 		{
-			set<int> s(sp1.begin(), sp1.end());
-			if(s.size() >= 2) hs.add_node_list(s);
+			add_hyper_edge(sp1, w);
 			sp1.clear();
+			w = 0;
 		}
 
 		qname = h.qname;
+		qhash = h.qhash;
 		hi = h.hi;
 
 		if((h.flag & 0x4) >= 1) continue;
 
-		vector<int64_t> v;
-		h.get_matched_intervals(v);
-
 		vector<int> sp2;
-		for(int k = 0; k < v.size(); k++)
-		{
-			int32_t p1 = high32(v[k]);
-			int32_t p2 = low32(v[k]);
-
-			int k1 = locate_left_partial_exon(p1);
-			int k2 = locate_right_partial_exon(p2);
-			if(k1 < 0 || k2 < 0) continue;
-
-			for(int j = k1; j <= k2; j++) sp2.push_back(j);
-		}
+		locate_partial_exons(h, sp2);
 
 		if(sp1.size() <= 0 || sp2.size() <= 0)
 		{
 			sp1.insert(sp1.end(), sp2.begin(), sp2.end());
+			if(sp2.size() >= 1 && h.weight > w) w = h.weight;
 			continue;
 		}
 
@@ -460,14 +462,15 @@ int bundle::build_hyper_edges2()
 
 		if(c == false)
 		{
-			set<int> s(sp1.begin(), sp1.end());
-			if(s.size() >= 2) hs.add_node_list(s);
+			add_hyper_edge(sp1, w);
 			sp1 = sp2;
+			w = h.weight;
 		}
 		else
 		{
 			sp1.insert(sp1.end(), sp2.begin(), sp2.end());
 			sp1.insert(sp1.end(), sp3.begin(), sp3.end());
+			if(h.weight > w) w = h.weight;
 		}
 	}
 
@@ -475,6 +478,24 @@ int bundle::build_hyper_edges2()
 }
 
 bool bundle::bridge_read(int x, int y, vector<int> &v)
+{
+	// many pairs of mates share (x, y), search the graph once for each
+	int64_t key = pack(x, y);
+	map<int64_t, PBVI>::iterator it = bridges.find(key);
+	if(it != bridges.end())
+	{
+		bridge_hits++;
+		v = it->second.second;
+		return it->second.first;
+	}
+
+	bridge_misses++;
+	bool b = search_bridge(x, y, v);
+	bridges.insert(pair<int64_t, PBVI>(key, PBVI(b, v)));
+	return b;
+}
+
+bool bundle::search_bridge(int x, int y, vector<int> &v)
 {
 	v.clear();
 	if(x >= y) return true;
@@ -685,6 +706,10 @@ int bundle::build_splice_graph()
 
 int bundle::revise_splice_graph()
 {
+	// each pass starts with all vertices, and then only looks at the
+	// vertices whose neighborhood changed since it last did
+	init_worklists();
+
 	while(true)
 	{
 		bool b = false;
@@ -718,72 +743,191 @@ int bundle::revise_splice_graph()
 	return 0;
 }
 
-int bundle::refine_splice_graph()
+int bundle::init_worklists()
 {
-	while(true)
-	{
-		bool b = false;
-		for(int i = 1; i < gr.num_vertices() - 1; i++)
-		{
-			if(gr.degree(i) == 0) continue;
-			if(gr.in_degree(i) >= 1 && gr.out_degree(i) >= 1) continue;
-			gr.clear_vertex(i);
-			b = true;
-		}
-		if(b == false) break;
-	}
+	set<int> s;
+	for(int i = 0; i < gr.num_vertices(); i++) s.insert(i);
+	wextend = s;
+	winner = s;
+	wexons = s;
+	wjunctions = s;
+	wintron = s;
+	wrefine = s;
+	extendable.clear();
 	return 0;
 }
 
-bool bundle::extend_boundaries()
+int bundle::touch_vertex(int v)
 {
+	// the passes look at a vertex, its edges, and the degrees of its
+	// neighbors other than the source and the sink
+	wextend.insert(v);
+	winner.insert(v);
+	wexons.insert(v);
+	wjunctions.insert(v);
+	wintron.insert(v);
+	wrefine.insert(v);
+
+	if(v == 0 || v == gr.num_vertices() - 1) return 0;
+
 	edge_iterator it1, it2;
 	PEEI pei;
-	for(pei = gr.edges(), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
+	vector<int> vu;
+	for(pei = gr.in_edges(v), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
 	{
-		edge_descriptor e = (*it1);
-		int s = e->source();
-		int t = e->target();
-		int32_t p = gr.get_vertex_info(t).lpos - gr.get_vertex_info(s).rpos;
-		double we = gr.get_edge_weight(e);
-		double ws = gr.get_vertex_weight(s);
-		double wt = gr.get_vertex_weight(t);
+		extendable.erase(*it1);
+		vu.push_back((*it1)->source());
+	}
+	for(pei = gr.out_edges(v), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
+	{
+		extendable.erase(*it1);
+		vu.push_back((*it1)->target());
+	}
 
-		if(p <= 0) continue;
-		if(s == 0) continue;
-		if(t == gr.num_vertices() - 1) continue;
+	for(int i = 0; i < vu.size(); i++)
+	{
+		winner.insert(vu[i]);
+		wexons.insert(vu[i]);
+		wjunctions.insert(vu[i]);
+		wintron.insert(vu[i]);
+		wrefine.insert(vu[i]);
+	}
+	return 0;
+}
 
-		bool b = false;
-		if(gr.out_degree(s) == 1 && ws >= 10.0 * we * we + 10.0) b = true;
-		if(gr.in_degree(t) == 1 && wt >= 10.0 * we * we + 10.0) b = true;
+int bundle::revise_clear_vertex(int v)
+{
+	// the degrees of all neighbors change
+	PEEI pi = gr.in_edges(v);
+	for(edge_iterator it = pi.first; it != pi.second; it++) touch_vertex((*it)->source());
+	PEEI po = gr.out_edges(v);
+	for(edge_iterator it = po.first; it != po.second; it++) touch_vertex((*it)->target());
+	touch_vertex(v);
+	gr.clear_vertex(v);
+	return 0;
+}
 
-		if(b == false) continue;
+int bundle::revise_remove_edge(edge_descriptor e)
+{
+	touch_vertex(e->source());
+	touch_vertex(e->target());
+	gr.remove_edge(e);
+	return 0;
+}
+
+edge_descriptor bundle::revise_add_edge(int s, int t)
+{
+	edge_descriptor e = gr.add_edge(s, t);
+	touch_vertex(s);
+	touch_vertex(t);
+	return e;
+}
+
+// smallest element of s that is at least x, which is removed from s, or -1
+static int next_vertex(set<int> &s, int x)
+{
+	set<int>::iterator it = s.lower_bound(x);
+	if(it == s.end()) return -1;
+	int v = *it;
+	s.erase(it);
+	return v;
+}
 
-		if(gr.out_degree(s) == 1)
+int bundle::refine_splice_graph()
+{
+	// sweep forward over the worklist and start over at the end,
+	// which removes dead ends in the same order as a full scan
+	int k = 0;
+	while(wrefine.size() >= 1)
+	{
+		int i = next_vertex(wrefine, k);
+		if(i == -1) k = 0;
+		if(i == -1) continue;
+		k = i + 1;
+		if(i == 0 || i == gr.num_vertices() - 1) continue;
+		if(gr.degree(i) == 0) continue;
+		if(gr.in_degree(i) >= 1 && gr.out_degree(i) >= 1) continue;
+		revise_clear_vertex(i);
+	}
+	return 0;
+}
+
+bool bundle::check_extendable(edge_descriptor e)
+{
+	int s = e->source();
+	int t = e->target();
+	int32_t p = gr.get_vertex_info(t).lpos - gr.get_vertex_info(s).rpos;
+	double we = gr.get_edge_weight(e);
+	double ws = gr.get_vertex_weight(s);
+	double wt = gr.get_vertex_weight(t);
+
+	if(p <= 0) return false;
+	if(s == 0) return false;
+	if(t == gr.num_vertices() - 1) return false;
+
+	if(gr.out_degree(s) == 1 && ws >= 10.0 * we * we + 10.0) return true;
+	if(gr.in_degree(t) == 1 && wt >= 10.0 * we * we + 10.0) return true;
+	return false;
+}
+
+bool bundle::extend_boundaries()
+{
+	// whether an edge is extendable only depends on the degrees of its
+	// ends, so only the edges of changed vertices are checked again
+	int n = gr.num_vertices() - 1;
+	for(set<int>::iterator it = wextend.begin(); it != wextend.end(); it++)
+	{
+		int v = *it;
+		if(v == 0 || v == n) continue;
+
+		edge_iterator it1, it2;
+		PEEI pei;
+		for(pei = gr.in_edges(v), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
 		{
-			edge_descriptor ee = gr.add_edge(s, gr.num_vertices() - 1);
-			gr.set_edge_weight(ee, ws);
-			gr.set_edge_info(ee, edge_info());
+			if(check_extendable(*it1) == true) extendable.insert(*it1);
+			else extendable.erase(*it1);
 		}
-		if(gr.in_degree(t) == 1)
+		for(pei = gr.out_edges(v), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
 		{
-			edge_descriptor ee = gr.add_edge(0, t);
-			gr.set_edge_weight(ee, wt);
-			gr.set_edge_info(ee, edge_info());
+			if(check_extendable(*it1) == true) extendable.insert(*it1);
+			else extendable.erase(*it1);
 		}
+	}
+	wextend.clear();
+
+	// act on the first extendable edge in the order of gr.edges()
+	if(extendable.size() == 0) return false;
 
-		gr.remove_edge(e);
+	edge_descriptor e = *(extendable.begin());
+	int s = e->source();
+	int t = e->target();
+	double ws = gr.get_vertex_weight(s);
+	double wt = gr.get_vertex_weight(t);
 
-		return true;
+	if(gr.out_degree(s) == 1)
+	{
+		edge_descriptor ee = revise_add_edge(s, n);
+		gr.set_edge_weight(ee, ws);
+		gr.set_edge_info(ee, edge_info());
+	}
+	if(gr.in_degree(t) == 1)
+	{
+		edge_descriptor ee = revise_add_edge(0, t);
+		gr.set_edge_weight(ee, wt);
+		gr.set_edge_info(ee, edge_info());
 	}
 
-	return false;
+	revise_remove_edge(e);
+	return true;
 }
 
 VE bundle::compute_maximal_edges()
 {
-	typedef pair<double, edge_descriptor> PDE;
-	vector<PDE> ve;
+	// pairs of weight and position in vx, such that ties are broken
+	// by the order of edges rather than by their addresses
+	typedef pair<double, int> PDI;
+	vector<PDI> ve;
+	VE vx;
 
 	undirected_graph ug;
 	edge_iterator it1, it2;
@@ -798,7 +942,8 @@ VE bundle::compute_maximal_edges()
 		if(s == 0) continue;
 		if(t == gr.num_vertices() - 1) continue;
 		ug.add_edge(s, t);
-		ve.push_back(PDE(w, e));
+		ve.push_back(PDI(w, vx.size()));
+		vx.push_back(e);
 	}
 
 	vector<int> vv = ug.assign_connected_components();
@@ -811,7 +956,7 @@ VE bundle::compute_maximal_edges()
 	set<int> sc;
 	for(int i = ve.size() - 1; i >= 0; i--)
 	{
-		edge_descriptor e = ve[i].second;
+		edge_descriptor e = vx[ve[i].second];
 		double w = gr.get_edge_weight(e);
 		if(w < 1.5) break;
 		int s = e->source();
@@ -900,7 +1045,7 @@ bool bundle::keep_surviving_edges()
 	for(int i = 0; i < ve.size(); i++)
 	{
 		if(verbose >= 2) printf("remove edge (%d, %d), weight = %.2lf\n", ve[i]->source(), ve[i]->target(), gr.get_edge_weight(ve[i]));
-		gr.remove_edge(ve[i]);
+		revise_remove_edge(ve[i]);
 	}
 
 	if(ve.size() >= 1) return true;
@@ -910,7 +1055,7 @@ bool bundle::keep_surviving_edges()
 bool bundle::remove_small_exons()
 {
 	bool flag = false;
-	for(int i = 1; i < gr.num_vertices() - 1; i++)
+	for(int i = next_vertex(wexons, 1); i >= 1 && i < gr.num_vertices() - 1; i = next_vertex(wexons, i + 1))
 	{
 		bool b = true;
 		edge_iterator it1, it2;
@@ -943,7 +1088,7 @@ bool bundle::remove_small_exons()
 		// only consider boundary small exons
 		if(gr.edge(0, i).second == false && gr.edge(i, gr.num_vertices() - 1).second == false) continue;
 
-		gr.clear_vertex(i);
+		revise_clear_vertex(i);
 		flag = true;
 	}
 	return flag;
@@ -952,7 +1097,7 @@ bool bundle::remove_small_exons()
 bool bundle::remove_small_junctions()
 {
 	SE se;
-	for(int i = 1; i < gr.num_vertices() - 1; i++)
+	for(int i = next_vertex(wjunctions, 1); i >= 1 && i < gr.num_vertices() - 1; i = next_vertex(wjunctions, i + 1))
 	{
 		if(gr.degree(i) <= 0) continue;
 
@@ -1024,7 +1169,7 @@ bool bundle::remove_small_junctions()
 	for(SE::iterator it = se.begin(); it != se.end(); it++)
 	{
 		edge_descriptor e = (*it);
-		gr.remove_edge(e);
+		revise_remove_edge(e);
 	}
 
 	return true;
@@ -1034,7 +1179,7 @@ bool bundle::remove_inner_boundaries()
 {
 	bool flag = false;
 	int n = gr.num_vertices() - 1;
-	for(int i = 1; i < gr.num_vertices() - 1; i++)
+	for(int i = next_vertex(winner, 1); i >= 1 && i < gr.num_vertices() - 1; i = next_vertex(winner, i + 1))
 	{
 		if(gr.in_degree(i) != 1) continue;
 		if(gr.out_degree(i) != 1) continue;
@@ -1060,7 +1205,7 @@ bool bundle::remove_inner_boundaries()
 		if(verbose >= 2) printf("remove inner boundary: vertex = %d, weight = %.2lf, length = %d, pos = %d-%d\n",
 				i, gr.get_vertex_weight(i), vi.length, vi.lpos, vi.rpos);
 
-		gr.clear_vertex(i);
+		revise_clear_vertex(i);
 		flag = true;
 	}
 	return flag;
@@ -1069,7 +1214,7 @@ bool bundle::remove_inner_boundaries()
 bool bundle::remove_intron_contamination()
 {
 	bool flag = false;
-	for(int i = 1; i < gr.num_vertices(); i++)
+	for(int i = next_vertex(wintron, 1); i >= 1 && i < gr.num_vertices(); i = next_vertex(wintron, i + 1))
 	{
 		if(gr.in_degree(i) != 1) continue;
 		if(gr.out_degree(i) != 1) continue;
@@ -1102,7 +1247,7 @@ bool bundle::remove_intron_contamination()
 
 		if(verbose >= 2) printf("clear intron contamination %d, weight = %.2lf, length = %d, edge weight = %.2lf\n", i, wv, vi.length, we);
 
-		gr.clear_vertex(i);
+		revise_clear_vertex(i);
 		flag = true;
 	}
 	return flag;
@@ -1121,19 +1266,9 @@ int bundle::count_junctions() const
 
 int bundle::print(int index)
 {
-	printf("Bundle %d: ", index);
-
-	// statistic xs
-	int n0 = 0, np = 0, nq = 0;
-	for(int i = 0; i < hits.size(); i++)
-	{
-		if(hits[i].xs == '.') n0++;
-		if(hits[i].xs == '+') np++;
-		if(hits[i].xs == '-') nq++;
-	}
-
-	printf("tid = %d, #hits = %lu, #partial-exons = %lu, range = %s:%d-%d, orient = %c (%d, %d, %d)\n",
-			tid, hits.size(), pexons.size(), chrm.c_str(), lpos, rpos, strand, n0, np, nq);
+	string s;
+	summarize(index, s);
+	printf("%s", s.c_str());
 
 	if(verbose <= 1) return 0;
 
@@ -1166,6 +1301,31 @@ int bundle::print(int index)
 	return 0;
 }
 
+int bundle::summarize(int index, string &s)
+{
+	// statistic xs
+	int n = 0, n0 = 0, np = 0, nq = 0;
+	for(int i = 0; i < hits.size(); i++)
+	{
+		n += hits[i].weight;
+		if(hits[i].xs == '.') n0 += hits[i].weight;
+		if(hits[i].xs == '+') np += hits[i].weight;
+		if(hits[i].xs == '-') nq += hits[i].weight;
+	}
+
+	char buf[2048];
+	sprintf(buf, "Bundle %d: tid = %d, #hits = %d, #partial-exons = %lu, range = %.1000s:%d-%d, orient = %c (%d, %d, %d)\n",
+			index, tid, n, pexons.size(), chrm.c_str(), lpos, rpos, strand, n0, np, nq);
+	s = buf;
+
+	if(verbose >= 1 && bridge_hits + bridge_misses >= 1)
+	{
+		sprintf(buf, "bridging: %d pairs, %d answered from cache, %d searched\n", bridge_hits + bridge_misses, bridge_hits, bridge_misses);
+		s += buf;
+	}
+	return 0;
+}
+
 int bundle::output_transcripts(ofstream &fout, const vector<path> &p, const string &gid) const
 {
 	for(int i = 0; i < p.size(); i++)
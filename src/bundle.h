@@ -11,6 +11,7 @@ See LICENSE for licensing.
 #include "bundle_base.h"
 #include "junction.h"
 #include "region.h"
+#include "coverage_index.h"
 #include "partial_exon.h"
 #include "splice_graph.h"
 #include "hyper_set.h"
@@ -20,19 +21,35 @@ See LICENSE for licensing.
 
 using namespace std;
 
+typedef pair< bool, vector<int> > PBVI;
+
 class bundle : public bundle_base
 {
 public:
-	bundle(const bundle_base &bb);
+	bundle(bundle_base &bb);		// takes over the content of bb
 	virtual ~bundle();
 
 public:
+	coverage_index mindex;			// flat index of mmap
 	vector<junction> junctions;		// splice junctions
 	vector<region> regions;			// regions
 	vector<partial_exon> pexons;	// partial exons
-	split_interval_map pmap;		// partial exon map
+	vector<int32_t> plpos;			// left positions of partial exons
+	vector<int32_t> prpos;			// right positions of partial exons
 	splice_graph gr;				// splice graph
 	hyper_set hs;					// hyper edges
+	map<int64_t, PBVI> bridges;		// outcome of bridge_read for each pair of partial exons
+	int bridge_hits;				// number of bridge_read calls answered by bridges
+	int bridge_misses;				// number of bridge_read calls that searched the graph
+
+	// worklists of revise_splice_graph: vertices each pass has to examine again
+	set<int> wextend;				// for extend_boundaries
+	set<int> winner;				// for remove_inner_boundaries
+	set<int> wexons;				// for remove_small_exons
+	set<int> wjunctions;			// for remove_small_junctions
+	set<int> wintron;				// for remove_intron_contamination
+	set<int> wrefine;				// for refine_splice_graph
+	SE extendable;					// edges extend_boundaries would act on
 
 public:
 	virtual int build();
@@ -43,6 +60,7 @@ public:
 	int output_transcript(transcript &trst, const path &p, const string &gid, const string &tid) const;	
 	int count_junctions() const;
 	int print(int index);
+	int summarize(int index, string &s);
 
 private:
 	// check and init
@@ -60,6 +78,7 @@ private:
 	int build_partial_exon_map();
 	int locate_left_partial_exon(int32_t x);
 	int locate_right_partial_exon(int32_t x);
+	int locate_partial_exons(const hit &h, vector<int> &v);
 
 	// revise splice graph
 	VE compute_maximal_edges();
@@ -71,11 +90,19 @@ private:
 	bool remove_small_exons();
 	bool remove_inner_boundaries();
 	bool remove_intron_contamination();
+	bool check_extendable(edge_descriptor e);
+	int init_worklists();
+	int touch_vertex(int v);
+	int revise_clear_vertex(int v);
+	int revise_remove_edge(edge_descriptor e);
+	edge_descriptor revise_add_edge(int s, int t);
 
 	// super edges
 	int build_hyper_edges1();			// single end
 	int build_hyper_edges2();			// paired end
+	int add_hyper_edge(vector<int> &v, int w);
 	bool bridge_read(int x, int y, vector<int> &s);
+	bool search_bridge(int x, int y, vector<int> &s);
 
 };
 
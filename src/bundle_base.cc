@@ -8,6 +8,9 @@ See LICENSE for licensing.
 #include <cstdio>
 #include <cmath>
 #include <climits>
+#include <algorithm>
+#include <map>
+#include <functional>
 
 #include "bundle_base.h"
 
@@ -18,16 +21,93 @@ bundle_base::bundle_base()
 	lpos = 1 << 30;
 	rpos = 0;
 	strand = '.';
+	depth = 0;
+	dropped = 0;
+}
+
+bundle_base::bundle_base(const bundle_base &bb)
+{
+	*this = bb;
+}
+
+bundle_base& bundle_base::operator=(const bundle_base &bb)
+{
+	if(this == &bb) return *this;
+
+	tid = bb.tid;
+	chrm = bb.chrm;
+	lpos = bb.lpos;
+	rpos = bb.rpos;
+	strand = bb.strand;
+	mmap = bb.mmap;
+	imap = bb.imap;
+	ends = bb.ends;
+	depth = bb.depth;
+	dropped = bb.dropped;
+
+	// hits refer to the arena of bb, copy their data into ours
+	hdata.clear();
+	hits = bb.hits;
+	for(int i = 0; i < hits.size(); i++) hits[i].attach(hdata);
+
+	return *this;
 }
 
 bundle_base::~bundle_base()
 {}
 
-int bundle_base::add_hit(const hit &ht)
+int bundle_base::add_hit(const hit &ht, int w)
 {
-	// store new hit
+	// store new hit, w is given by sample
 	hits.push_back(ht);
+	hits.back().attach(hdata);
+	hits.back().weight *= w;
+	return update(ht);
+}
+
+int bundle_base::add_shared_hit(const hit &ht, int w)
+{
+	// the data of ht is owned by the caller and must outlive this bundle
+	hits.push_back(ht);
+	hits.back().weight *= w;
+	return update(ht);
+}
 
+int bundle_base::sample(const hit &ht)
+{
+	// where the depth reaches max_bundle_depth, find the smallest power of
+	// two k that brings it under the cap, and keep only the reads whose name
+	// hash is 0 modulo k, with weight k; mates share the hash, and a read
+	// kept for some k is also kept for any smaller k
+	if(max_bundle_depth <= 0) return 1;
+
+	while(ends.size() >= 1 && high32(ends.front()) <= ht.pos)
+	{
+		depth -= low32(ends.front());
+		pop_heap(ends.begin(), ends.end(), greater<int64_t>());
+		ends.pop_back();
+	}
+
+	int k = 1;
+	while(k < (1 << 20) && depth >= (int64_t)(max_bundle_depth) * k) k *= 2;
+
+	uint64_t x = (ht.qhash * 0x9e3779b97f4a7c15ull) >> 40;
+	if((x & (k - 1)) != 0)
+	{
+		// still extend the bundle, which decides where the next one starts
+		if(ht.rpos > rpos) rpos = ht.rpos;
+		dropped++;
+		return 0;
+	}
+
+	ends.push_back(pack(ht.rpos, k));
+	push_heap(ends.begin(), ends.end(), greater<int64_t>());
+	depth += k;
+	return k;
+}
+
+int bundle_base::update(const hit &ht)
+{
 	// calcuate the boundaries on reference
 	if(ht.pos < lpos) lpos = ht.pos;
 	if(ht.rpos > rpos) rpos = ht.rpos;
@@ -48,35 +128,108 @@ int bundle_base::add_hit(const hit &ht)
 	}
 	*/
 
-	// add intervals
+	return 0;
+}
+
+int bundle_base::build_maps()
+{
+	// called by bundle::build, so bundles dropped in assembler::process never pay for it
 	vector<int64_t> vm;
 	vector<int64_t> vi;
-	vector<int64_t> vd;
-	ht.get_mid_intervals(vm, vi, vd);
+	vector<int> wm;
+	vector<int> wi;
+	bool weighted = false;
+	for(int i = 0; i < hits.size(); i++)
+	{
+		hits[i].add_mid_intervals(vm, vi, vi);
+		wm.resize(vm.size(), hits[i].weight);
+		wi.resize(vi.size(), hits[i].weight);
+		if(hits[i].weight != 1) weighted = true;
+	}
 
-	//ht.print();
-	for(int k = 0; k < vm.size(); k++)
+	if(weighted == false)
+	{
+		add_intervals(mmap, vm);
+		add_intervals(imap, vi);
+	}
+	else
 	{
-		int32_t s = high32(vm[k]);
-		int32_t t = low32(vm[k]);
-		//printf(" add interval %d-%d\n", s, t);
-		mmap += make_pair(ROI(s, t), 1);
+		add_intervals(mmap, vm, wm);
+		add_intervals(imap, vi, wi);
 	}
+	return 0;
+}
+
+int bundle_base::collapse()
+{
+	// a read (all alignments sharing a name) is merged into an earlier
+	// read whose alignments are the same one by one, in hit::operator< order
+	vector<int> order;
+	group_by_name(hits, order);
 
-	for(int k = 0; k < vi.size(); k++)
+	vector<int> fs;				// start of each read in order
+	for(int i = 0, j = 0; i < order.size(); i = j)
 	{
-		int32_t s = high32(vi[k]);
-		int32_t t = low32(vi[k]);
-		imap += make_pair(ROI(s, t), 1);
+		const char *q = hits[order[i]].qname;
+		for(j = i + 1; j < order.size() && strcmp(hits[order[j]].qname, q) == 0; j++);
+		fs.push_back(i);
 	}
+	fs.push_back(order.size());
 
-	for(int k = 0; k < vd.size(); k++)
+	// bundle::build_hyper_edges2 leaves out the read with the greatest name, keep it alone
+	int last = 0;
+	for(int f = 1; f < fs.size() - 1; f++)
 	{
-		int32_t s = high32(vd[k]);
-		int32_t t = low32(vd[k]);
-		imap += make_pair(ROI(s, t), 1);
+		if(strcmp(hits[order[fs[f]]].qname, hits[order[fs[last]]].qname) > 0) last = f;
 	}
 
+	map< uint64_t, vector<int> > m;		// from hash to distinct reads
+	vector<int> rep(fs.size() - 1, -1);	// distinct read each read is merged into
+	for(int f = 0; f < fs.size() - 1; f++)
+	{
+		rep[f] = f;
+		if(f == last) continue;
+
+		uint64_t x = fs[f + 1] - fs[f];
+		for(int i = fs[f]; i < fs[f + 1]; i++) x = (x ^ hits[order[i]].alignment_hash()) * 1099511628211ull;
+
+		vector<int> &v = m[x];
+		for(int k = 0; k < v.size() && rep[f] == f; k++)
+		{
+			int g = v[k];
+			if(fs[g + 1] - fs[g] != fs[f + 1] - fs[f]) continue;
+
+			bool b = true;
+			for(int i = 0; i < fs[f + 1] - fs[f] && b == true; i++)
+			{
+				b = hits[order[fs[f] + i]].same_alignment(hits[order[fs[g] + i]]);
+			}
+			if(b == true) rep[f] = g;
+		}
+
+		if(rep[f] == f) v.push_back(f);
+	}
+
+	// add up the weights and keep the hits of distinct reads, in their order
+	vector<bool> keep(hits.size(), false);
+	for(int f = 0; f < fs.size() - 1; f++)
+	{
+		int g = rep[f];
+		for(int i = fs[f]; i < fs[f + 1]; i++)
+		{
+			if(g == f) keep[order[i]] = true;
+			else hits[order[fs[g] + i - fs[f]]].weight += hits[order[i]].weight;
+		}
+	}
+
+	int n = 0;
+	for(int i = 0; i < hits.size(); i++)
+	{
+		if(keep[i] == false) continue;
+		if(n != i) hits[n] = hits[i];
+		n++;
+	}
+	hits.erase(hits.begin() + n, hits.end());
 	return 0;
 }
 
@@ -87,6 +240,24 @@ bool bundle_base::overlap(const hit &ht) const
 	return false;
 }
 
+int bundle_base::swap(bundle_base &bb)
+{
+	// exchange contents without copying hits or interval maps
+	std::swap(tid, bb.tid);
+	chrm.swap(bb.chrm);
+	std::swap(lpos, bb.lpos);
+	std::swap(rpos, bb.rpos);
+	std::swap(strand, bb.strand);
+	hits.swap(bb.hits);
+	hdata.swap(bb.hdata);
+	mmap.swap(bb.mmap);
+	imap.swap(bb.imap);
+	ends.swap(bb.ends);
+	std::swap(depth, bb.depth);
+	std::swap(dropped, bb.dropped);
+	return 0;
+}
+
 int bundle_base::clear()
 {
 	tid = -1;
@@ -95,8 +266,12 @@ int bundle_base::clear()
 	rpos = 0;
 	strand = '.';
 	hits.clear();
+	hdata.clear();
 	mmap.clear();
 	imap.clear();
+	ends.clear();
+	depth = 0;
+	dropped = 0;
 	return 0;
 }
 
@@ -21,6 +21,8 @@ class bundle_base
 {
 public:
 	bundle_base();
+	bundle_base(const bundle_base &bb);
+	bundle_base& operator=(const bundle_base &bb);
 	virtual ~bundle_base();
 
 public:
@@ -30,13 +32,25 @@ public:
 	int32_t rpos;					// the rightmost boundary on reference
 	char strand;					// strandness
 	vector<hit> hits;				// hits
+	arena hdata;					// cigar, qname and splice positions of hits
 	split_interval_map mmap;		// matched interval map
 	split_interval_map imap;		// indel interval map
+	vector<int64_t> ends;			// min-heap of right positions and weights of hits, for the depth cap
+	int32_t depth;					// summed weight of the hits in ends
+	int32_t dropped;				// number of hits left out by the depth cap
 
 public:
-	int add_hit(const hit &ht);
+	int sample(const hit &ht);		// weight of ht under the depth cap, 0 if it is left out
+	int add_hit(const hit &ht, int w);
+	int add_shared_hit(const hit &ht, int w);
+	int build_maps();				// fill mmap and imap with the hits
+	int collapse();					// merge reads with identical alignments
 	bool overlap(const hit &ht) const;
+	int swap(bundle_base &bb);
 	int clear();
+
+private:
+	int update(const hit &ht);
 };
 
 #endif
@@ -25,6 +25,8 @@ uint32_t min_mapping_quality = 1;
 int32_t min_splice_boundary_hits = 1;
 bool use_second_alignment = false;
 bool uniquely_mapped_only = false;
+bool collapse_duplicates = false;
+int max_bundle_depth = 0;
 int library_type = EMPTY;
 
 // for preview
@@ -74,7 +76,9 @@ string output_file;
 // for controling
 bool output_tex_files = false;
 string fixed_gene_name = "";
-int batch_bundle_size = 100;
+int num_threads = 1;
+bool region_parallel = false;
+int decode_threads = 0;
 int verbose = 1;
 string version = "v0.10.3";
 
@@ -174,6 +178,18 @@ int parse_arguments(int argc, const char ** argv)
 			min_splice_boundary_hits = atoi(argv[i + 1]);
 			i++;
 		}
+		else if(string(argv[i]) == "--collapse_duplicates")
+		{
+			string s(argv[i + 1]);
+			if(s == "true") collapse_duplicates = true;
+			else collapse_duplicates = false;
+			i++;
+		}
+		else if(string(argv[i]) == "--max_bundle_depth")
+		{
+			max_bundle_depth = atoi(argv[i + 1]);
+			i++;
+		}
 		else if(string(argv[i]) == "--max_preview_spliced_reads")
 		{
 			max_preview_spliced_reads = atoi(argv[i + 1]);
@@ -337,9 +353,21 @@ int parse_arguments(int argc, const char ** argv)
 			verbose = atoi(argv[i + 1]);
 			i++;
 		}
-		else if(string(argv[i]) == "--batch_bundle_size")
+		else if(string(argv[i]) == "-p" || string(argv[i]) == "--threads")
+		{
+			num_threads = atoi(argv[i + 1]);
+			i++;
+		}
+		else if(string(argv[i]) == "--region_parallel")
+		{
+			string s(argv[i + 1]);
+			if(s == "true") region_parallel = true;
+			else region_parallel = false;
+			i++;
+		}
+		else if(string(argv[i]) == "--decode_threads")
 		{
-			batch_bundle_size = atoi(argv[i + 1]);
+			decode_threads = atoi(argv[i + 1]);
 			i++;
 		}
 	}
@@ -377,6 +405,8 @@ int print_parameters()
 	printf("min_num_hits_in_bundle = %d\n", min_num_hits_in_bundle);
 	printf("min_mapping_quality = %d\n", min_mapping_quality);
 	printf("min_splice_boundary_hits = %d\n", min_splice_boundary_hits);
+	printf("collapse_duplicates = %c\n", collapse_duplicates ? 'T' : 'F');
+	printf("max_bundle_depth = %d\n", max_bundle_depth);
 
 	// for preview
 	printf("preview_only = %c\n", preview_only ? 'T' : 'F');
@@ -425,7 +455,9 @@ int print_parameters()
 	printf("use_second_alignment = %c\n", use_second_alignment ? 'T' : 'F');
 	printf("uniquely_mapped_only = %c\n", uniquely_mapped_only ? 'T' : 'F');
 	printf("verbose = %d\n", verbose);
-	printf("batch_bundle_size = %d\n", batch_bundle_size);
+	printf("num_threads = %d\n", num_threads);
+	printf("region_parallel = %c\n", region_parallel ? 'T' : 'F');
+	printf("decode_threads = %d\n", decode_threads);
 
 	printf("\n");
 
@@ -472,6 +504,9 @@ int print_help()
 	printf(" %-42s  %s\n", "--version",  "print current version of Scallop and exit");
 	printf(" %-42s  %s\n", "--verbose <0, 1, 2>",  "0: quiet; 1: one line for each graph; 2: with details, default: 1");
 	printf(" %-42s  %s\n", "--library_type <first, second, unstranded>",  "library type of the sample, default: unstranded");
+	printf(" %-42s  %s\n", "-p, --threads <integer>",  "number of threads used to assemble bundles, default: 1");
+	printf(" %-42s  %s\n", "--region_parallel <true, false>",  "assemble contigs in parallel using the bam/csi index, default: false");
+	printf(" %-42s  %s\n", "--decode_threads <integer>",  "number of threads used to decompress the input, default: 0");
 	printf(" %-42s  %s\n", "--min_transcript_coverage <float>",  "minimum coverage required for a multi-exon transcript, default: 1.01");
 	printf(" %-42s  %s\n", "--min_single_exon_coverage <float>",  "minimum coverage required for a single-exon transcript, default: 20");
 	printf(" %-42s  %s\n", "--min_transcript_length_increase <integer>",  "default: 50");
@@ -483,6 +518,8 @@ int print_help()
 	printf(" %-42s  %s\n", "--min_num_hits_in_bundle <integer>",  "minimum number of reads required in a bundle, default: 20");
 	printf(" %-42s  %s\n", "--min_flank_length <integer>",  "minimum match length in each side for a spliced read, default: 3");
 	printf(" %-42s  %s\n", "--min_splice_bundary_hits <integer>",  "minimum number of spliced reads required for a junction, default: 1");
+	printf(" %-42s  %s\n", "--collapse_duplicates <true, false>",  "merge reads with identical alignments into weighted reads, default: false");
+	printf(" %-42s  %s\n", "--max_bundle_depth <integer>",  "subsample reads where the depth exceeds this value, 0 for no limit, default: 0");
 	return 0;
 }
 
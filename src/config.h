@@ -50,6 +50,8 @@ extern uint32_t min_mapping_quality;
 extern int32_t min_splice_boundary_hits;
 extern bool uniquely_mapped_only;
 extern bool use_second_alignment;
+extern bool collapse_duplicates;
+extern int max_bundle_depth;
 
 // for preview
 extern bool preview_only;
@@ -100,7 +102,9 @@ extern string fixed_gene_name;
 extern int max_num_bundles;
 extern int library_type;
 extern int min_gtf_transcripts_num;
-extern int batch_bundle_size;
+extern int num_threads;
+extern bool region_parallel;
+extern int decode_threads;
 extern int verbose;
 extern string version;
 
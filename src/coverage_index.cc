@@ -0,0 +1,124 @@
+/*
+Part of Scallop Transcript Assembler
+(c) 2017 by  Mingfu Shao, Carl Kingsford, and Carnegie Mellon University.
+See LICENSE for licensing.
+*/
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+#include "coverage_index.h"
+
+coverage_index::coverage_index()
+{}
+
+int coverage_index::build(const split_interval_map &imap)
+{
+	clear();
+
+	int n = imap.iterative_size();
+	lpos.reserve(n);
+	rpos.reserve(n);
+	count.reserve(n);
+	slen.reserve(n + 1);
+	sum1.reserve(n + 1);
+	sum2.reserve(n + 1);
+
+	slen.push_back(0);
+	sum1.push_back(0);
+	sum2.push_back(0);
+	for(SIMI it = imap.begin(); it != imap.end(); it++)
+	{
+		int32_t l = lower(it->first);
+		int32_t r = upper(it->first);
+		int64_t c = it->second;
+		assert(r > l);
+
+		lpos.push_back(l);
+		rpos.push_back(r);
+		count.push_back(c);
+		slen.push_back(slen.back() + (r - l));
+		sum1.push_back(sum1.back() + c * (r - l));
+		sum2.push_back(sum2.back() + c * c * (r - l));
+	}
+
+	joint.resize(lpos.size());
+	for(int i = (int)(lpos.size()) - 1; i >= 0; i--)
+	{
+		if(i + 1 < lpos.size() && rpos[i] == lpos[i + 1]) joint[i] = joint[i + 1];
+		else joint[i] = i;
+	}
+	return 0;
+}
+
+int coverage_index::clear()
+{
+	lpos.clear();
+	rpos.clear();
+	count.clear();
+	slen.clear();
+	sum1.clear();
+	sum2.clear();
+	joint.clear();
+	return 0;
+}
+
+bool coverage_index::locate(int32_t x, int32_t y, int &i, int &j) const
+{
+	// segments [i, j) are the ones with x <= lpos and rpos <= y
+	i = lower_bound(lpos.begin(), lpos.end(), x) - lpos.begin();
+	j = upper_bound(rpos.begin(), rpos.end(), y) - rpos.begin();
+	return (i < j);
+}
+
+int32_t coverage_index::compute_sum_overlap(int32_t x, int32_t y) const
+{
+	int i, j;
+	if(locate(x, y, i, j) == false) return 0;
+	return (int32_t)(sum1[j] - sum1[i]);
+}
+
+int coverage_index::evaluate_rectangle(int32_t x, int32_t y, double &ave, double &dev) const
+{
+	ave = 0;
+	dev = 1.0;
+
+	int i, j;
+	if(locate(x, y, i, j) == false) return 0;
+
+	int64_t s = sum1[j] - sum1[i];
+	ave = 1.0 * s / (y - x);
+
+	// sum of (count - ave)^2 * length over the segments, from the moments
+	long double q = sum2[j] - sum2[i];
+	long double var = q - 2.0L * ave * s + (long double)(ave) * ave * (slen[j] - slen[i]);
+
+	// when the moments nearly cancel (flat coverage) the rounding error
+	// may be as large as var itself, so sum up the segments directly
+	if(var <= 1e-9 * q)
+	{
+		var = 0;
+		for(int k = i; k < j; k++) var += (count[k] - ave) * (count[k] - ave) * (rpos[k] - lpos[k]);
+	}
+
+	dev = sqrt((double)(var) / (y - x));
+	return 0;
+}
+
+int coverage_index::get_joint_intervals(int32_t x, int32_t y, vector<PI32> &v) const
+{
+	// the union of the segments inside [x, y), as maximal intervals
+	v.clear();
+
+	int i, j;
+	if(locate(x, y, i, j) == false) return 0;
+
+	while(i < j)
+	{
+		int k = joint[i] < j - 1 ? joint[i] : j - 1;
+		v.push_back(PI32(lpos[i], rpos[k]));
+		i = k + 1;
+	}
+	return 0;
+}
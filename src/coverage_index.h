@@ -0,0 +1,44 @@
+/*
+Part of Scallop Transcript Assembler
+(c) 2017 by  Mingfu Shao, Carl Kingsford, and Carnegie Mellon University.
+See LICENSE for licensing.
+*/
+
+#ifndef __COVERAGE_INDEX_H__
+#define __COVERAGE_INDEX_H__
+
+#include <stdint.h>
+#include <vector>
+
+#include "interval_map.h"
+#include "util.h"
+
+using namespace std;
+
+// the segments of a split_interval_map in flat arrays, with prefix sums;
+// as with locate_boundary_iterators, a query [x, y) covers the segments
+// that lie completely inside it
+class coverage_index
+{
+public:
+	coverage_index();
+
+public:
+	vector<int32_t> lpos;			// left position of each segment
+	vector<int32_t> rpos;			// right position of each segment
+	vector<int32_t> count;			// overlap of each segment
+	vector<int64_t> slen;			// prefix sums of length
+	vector<int64_t> sum1;			// prefix sums of count * length
+	vector<int64_t> sum2;			// prefix sums of count * count * length
+	vector<int> joint;				// last segment that touches each segment in a chain
+
+public:
+	int build(const split_interval_map &imap);
+	int clear();
+	bool locate(int32_t x, int32_t y, int &i, int &j) const;
+	int32_t compute_sum_overlap(int32_t x, int32_t y) const;
+	int evaluate_rectangle(int32_t x, int32_t y, double &ave, double &dev) const;
+	int get_joint_intervals(int32_t x, int32_t y, vector<PI32> &v) const;
+};
+
+#endif
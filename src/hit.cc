@@ -9,6 +9,7 @@ See LICENSE for licensing.
 #include <cstdio>
 #include <sstream>
 #include <cmath>
+#include <algorithm>
 
 #include "hit.h"
 #include "config.h"
@@ -28,84 +29,140 @@ hit::hit(int32_t p)
 }
 */
 
-hit& hit::operator=(const hit &h)
+hit::hit(bam1_t *b)
+	:bam1_core_t(b->core)
 {
-	bam1_core_t::operator=(h);
-	rpos = h.rpos;
-	qlen = h.qlen;
-	qname = h.qname;
-	strand = h.strand;
-	spos = h.spos;
-	xs = h.xs;
-	ts = h.ts;
-	hi = h.hi;
-	nm = h.nm;
-
-	cigar = new uint32_t[h.n_cigar];
-	memcpy(cigar, h.cigar, 4 * h.n_cigar);
-	return *this;
+	// refer to query name and cigar in b
+	qname = bam_get_qname(b);
+	cigar = bam_get_cigar(b);
+	spos = NULL;
+	n_spos = 0;
+
+	// FNV-1a, used to group mates without comparing names
+	qhash = 14695981039346656037ull;
+	for(const char *p = qname; *p != '\0'; p++) qhash = (qhash ^ (uint8_t)(*p)) * 1099511628211ull;
+	weight = 1;
+
+	// compute rpos and qlen, and check for skips, in one pass
+	rpos = pos;
+	qlen = 0;
+	spliced = false;
+	for(int k = 0; k < n_cigar; k++)
+	{
+		int op = bam_cigar_op(cigar[k]);
+		int32_t len = bam_cigar_oplen(cigar[k]);
+		if(bam_cigar_type(op) & 2) rpos += len;
+		if(bam_cigar_type(op) & 1) qlen += len;
+		if(op == BAM_CREF_SKIP) spliced = true;
+	}
+
+	assert(n_cigar <= max_num_cigar);
+	assert(n_cigar >= 1);
 }
 
-hit::hit(const hit &h)
-	:bam1_core_t(h)
+int hit::attach(arena &a)
 {
-	rpos = h.rpos;
-	qlen = h.qlen;
-	qname = h.qname;
-	strand = h.strand;
-	spos = h.spos;
-	xs = h.xs;
-	ts = h.ts;
-	hi = h.hi;
-	nm = h.nm;
-
-	//printf("call copy constructor\n");
-	cigar = new uint32_t[h.n_cigar];
-	memcpy(cigar, h.cigar, 4 * h.n_cigar);
-	//printf("n-cigar = %d, h.n_cigar = %d, size of cigar = %lu | %u\n", n_cigar, h.n_cigar, sizeof cigar, sizeof h.cigar);
+	uint32_t *c = (uint32_t*)a.allocate(4 * n_cigar);
+	memcpy(c, cigar, 4 * n_cigar);
+	cigar = c;
+
+	int l = strlen(qname) + 1;
+	char *q = a.allocate(l);
+	memcpy(q, qname, l);
+	qname = q;
+
+	// only a cigar with skips can have splice positions
+	if(spliced == true) return build_splice_positions(a);
+
+	spos = NULL;
+	n_spos = 0;
+	return 0;
 }
 
-hit::~hit()
+// size of an aux value of fixed-size type t, 0 for other types
+static int aux_type_size(char t)
 {
-	assert(cigar != NULL);
-	delete[] cigar;
+	if(t == 'A' || t == 'c' || t == 'C') return 1;
+	if(t == 's' || t == 'S') return 2;
+	if(t == 'i' || t == 'I' || t == 'f') return 4;
+	if(t == 'd') return 8;
+	return 0;
 }
 
-hit::hit(bam1_t *b)
-	:bam1_core_t(b->core)
+// size of the aux value of type t starting at v, -1 if it is malformed
+static int aux_value_size(char t, const uint8_t *v, const uint8_t *e)
 {
-	// fetch query name
-	char buf[1024];
-	char *q = bam_get_qname(b);
-	int l = strlen(q);
-	memcpy(buf, q, l);
-	buf[l] = '\0';
-	qname = string(buf);
-
-	// compute rpos
-	rpos = pos + (int32_t)bam_cigar2rlen(n_cigar, bam_get_cigar(b));
-	qlen = (int32_t)bam_cigar2qlen(n_cigar, bam_get_cigar(b));
-
-	// copy cigar
-	assert(n_cigar <= max_num_cigar);
-	assert(n_cigar >= 1);
+	int w = aux_type_size(t);
+	if(w >= 1) return w;
 
-	// allocate memery for cigar
-	cigar = new uint32_t[n_cigar];
-	memcpy(cigar, bam_get_cigar(b), 4 * n_cigar);
+	if(t == 'Z' || t == 'H')
+	{
+		const uint8_t *p = (const uint8_t*)memchr(v, 0, e - v);
+		if(p == NULL) return -1;
+		return p - v + 1;
+	}
 
-	//printf("call regular constructor\n");
+	if(t == 'B' && v + 5 <= e)
+	{
+		int32_t n;
+		memcpy(&n, v + 1, 4);
+		w = aux_type_size(v[0]);
+		if(w <= 0 || n < 0) return -1;
+		return 5 + n * w;
+	}
+
+	return -1;
+}
+
+// position of a tag in the list of tags used by set_tags, -1 if not used
+static int aux_tag_index(uint8_t a, uint8_t b)
+{
+	if(a == 't' && b == 's') return 0;
+	if(a == 'X' && b == 'S') return 1;
+	if(a == 'H' && b == 'I') return 2;
+	if(a == 'N' && b == 'H') return 3;
+	if(a == 'n' && b == 'M') return 4;
+	if(a == 'N' && b == 'M') return 5;
+	return -1;
 }
 
 int hit::set_tags(bam1_t *b)
 {
 	ts = '.';
-	uint8_t *p0 = bam_aux_get(b, "ts");
-	if(p0 && (*p0) == 'A') ts = bam_aux2A(p0);
-
 	xs = '.';
-	uint8_t *p1 = bam_aux_get(b, "XS");
-	if(p1 && (*p1) == 'A') xs = bam_aux2A(p1);
+	hi = -1;
+	nh = -1;
+	nm = 0;
+
+	// walk the aux data once; as with bam_aux_get, only the first
+	// occurrence of a tag counts, and integers must be of type 'C'
+	int32_t nm2 = -1;
+	int seen = 0;
+	const uint8_t *s = bam_get_aux(b);
+	const uint8_t *e = b->data + b->l_data;
+	while(s + 3 <= e && seen != 63)
+	{
+		char t = s[2];
+		const uint8_t *v = s + 3;
+		int w = aux_value_size(t, v, e);
+		if(w < 0 || v + w > e) break;
+
+		int k = aux_tag_index(s[0], s[1]);
+		if(k >= 0 && (seen & (1 << k)) == 0)
+		{
+			seen |= (1 << k);
+			if(k == 0 && t == 'A') ts = v[0];
+			if(k == 1 && t == 'A') xs = v[0];
+			if(k == 2 && t == 'C') hi = v[0];
+			if(k == 3 && t == 'C') nh = v[0];
+			if(k == 4 && t == 'C') nm = v[0];
+			if(k == 5 && t == 'C') nm2 = v[0];
+		}
+		s = v + w;
+	}
+
+	// NM takes precedence over nM
+	if(nm2 >= 0) nm = nm2;
 
 	if(xs == '.' && ts != '.')
 	{
@@ -116,21 +173,6 @@ int hit::set_tags(bam1_t *b)
 		if((flag & 0x10) <= 0 && ts == '-') xs = '-';
 	}
 
-	hi = -1;
-	uint8_t *p2 = bam_aux_get(b, "HI");
-	if(p2 && (*p2) == 'C') hi = bam_aux2i(p2);
-
-	nh = -1;
-	uint8_t *p3 = bam_aux_get(b, "NH");
-	if(p3 && (*p3) == 'C') nh = bam_aux2i(p3);
-
-	nm = 0;
-	uint8_t *p4 = bam_aux_get(b, "nM");
-	if(p4 && (*p4) == 'C') nm = bam_aux2i(p4);
-
-	uint8_t *p5 = bam_aux_get(b, "NM");
-	if(p5 && (*p5) == 'C') nm = bam_aux2i(p5);
-
 	return 0;
 }
 
@@ -146,42 +188,28 @@ int hit::set_concordance()
 
 int hit::set_strand()
 {
-	strand = '.';
-	
-	if(library_type == FR_FIRST && ((flag & 0x1) >= 1))
-	{
-		if((flag & 0x10) <= 0 && (flag & 0x40) >= 1 && (flag & 0x80) <= 0) strand = '-';
-		if((flag & 0x10) >= 1 && (flag & 0x40) >= 1 && (flag & 0x80) <= 0) strand = '+';
-		if((flag & 0x10) <= 0 && (flag & 0x40) <= 0 && (flag & 0x80) >= 1) strand = '+';
-		if((flag & 0x10) >= 1 && (flag & 0x40) <= 0 && (flag & 0x80) >= 1) strand = '-';
-	}
-
-	if(library_type == FR_SECOND && ((flag & 0x1) >= 1))
+	// strand of each library type, indexed by bits 0x1, 0x10, 0x40 and 0x80 of flag
+	static const char table[3][16] = 
 	{
-		if((flag & 0x10) <= 0 && (flag & 0x40) >= 1 && (flag & 0x80) <= 0) strand = '+';
-		if((flag & 0x10) >= 1 && (flag & 0x40) >= 1 && (flag & 0x80) <= 0) strand = '-';
-		if((flag & 0x10) <= 0 && (flag & 0x40) <= 0 && (flag & 0x80) >= 1) strand = '-';
-		if((flag & 0x10) >= 1 && (flag & 0x40) <= 0 && (flag & 0x80) >= 1) strand = '+';
-	}
-
-	if(library_type == FR_FIRST && ((flag & 0x1) <= 0))
-	{
-		if((flag & 0x10) <= 0) strand = '-';
-		if((flag & 0x10) >= 1) strand = '+';
-	}
+		{'.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},	// UNSTRANDED
+		{'-', '.', '+', '.', '-', '-', '+', '+', '-', '+', '+', '-', '-', '.', '+', '.'},	// FR_FIRST
+		{'+', '.', '-', '.', '+', '+', '-', '-', '+', '-', '-', '+', '+', '.', '-', '.'},	// FR_SECOND
+	};
 
-	if(library_type == FR_SECOND && ((flag & 0x1) <= 0))
-	{
-		if((flag & 0x10) <= 0) strand = '+';
-		if((flag & 0x10) >= 1) strand = '-';
-	}
+	strand = '.';
+	if(library_type < UNSTRANDED || library_type > FR_SECOND) return 0;
 
+	int k = (flag & 0x1) | ((flag >> 3) & 0x2) | ((flag >> 4) & 0x4) | ((flag >> 4) & 0x8);
+	strand = table[library_type][k];
 	return 0;
 }
 
-int hit::build_splice_positions()
+int hit::build_splice_positions(arena &a)
 {
-	spos.clear();
+	// a splice position is between two matches
+	n_spos = 0;
+	spos = n_cigar >= 3 ? (int64_t*)a.allocate(8 * ((n_cigar - 1) / 2)) : NULL;
+
 	int32_t p = pos;
 	int32_t q = 0;
 	//uint8_t *seq = bam_get_seq(b);
@@ -201,20 +229,61 @@ int hit::build_splice_positions()
 		if(bam_cigar_oplen(cigar[k+1]) < min_flank_length) continue;
 
 		int32_t s = p - bam_cigar_oplen(cigar[k]);
-		spos.push_back(pack(s, p));
+		spos[n_spos++] = pack(s, p);
 	}
 	return 0;
 }
 
 bool hit::operator<(const hit &h) const
 {
-	if(qname < h.qname) return true;
-	if(qname > h.qname) return false;
+	int c = strcmp(qname, h.qname);
+	if(c < 0) return true;
+	if(c > 0) return false;
 	if(hi != -1 && h.hi != -1 && hi < h.hi) return true;
 	if(hi != -1 && h.hi != -1 && hi > h.hi) return false;
 	return (pos < h.pos);
 }
 
+uint64_t hit::alignment_hash() const
+{
+	// hash everything bundle uses of a hit, except its name
+	int64_t v[8] = {pos, flag, mpos, isize, hi, nm, xs, strand};
+	uint64_t x = 14695981039346656037ull;
+	for(int k = 0; k < 8; k++) x = (x ^ (uint64_t)v[k]) * 1099511628211ull;
+	for(int k = 0; k < n_cigar; k++) x = (x ^ cigar[k]) * 1099511628211ull;
+	return x;
+}
+
+bool hit::same_alignment(const hit &h) const
+{
+	if(pos != h.pos || flag != h.flag || mpos != h.mpos || isize != h.isize) return false;
+	if(hi != h.hi || nm != h.nm || xs != h.xs || strand != h.strand) return false;
+	if(n_cigar != h.n_cigar) return false;
+	return memcmp(cigar, h.cigar, 4 * n_cigar) == 0;
+}
+
+int group_by_name(const vector<hit> &hits, vector<int> &order)
+{
+	// order by name hash, then by hit::operator< inside each run of
+	// equal hashes, which separates names that collide
+	order.clear();
+	if(hits.size() == 0) return 0;
+
+	vector<PUI> vh(hits.size());
+	for(int i = 0; i < hits.size(); i++) vh[i] = PUI(hits[i].qhash, i);
+	radix_sort(vh);
+
+	order.resize(hits.size());
+	for(int i = 0; i < vh.size(); i++) order[i] = vh[i].second;
+
+	for(int i = 0, j = 0; i < vh.size(); i = j)
+	{
+		for(j = i + 1; j < vh.size() && vh[j].first == vh[i].first; j++);
+		if(j - i >= 2) stable_sort(order.begin() + i, order.begin() + j, hit_index_compare(hits));
+	}
+	return 0;
+}
+
 int hit::print() const
 {
 	// get cigar string
@@ -227,10 +296,10 @@ int hit::print() const
 
 	// print basic information
 	printf("Hit %s: [%d-%d), mpos = %d, cigar = %s, flag = %d, quality = %d, strand = %c, xs = %c, ts = %c, isize = %d, qlen = %d, hi = %d\n", 
-			qname.c_str(), pos, rpos, mpos, sstr.str().c_str(), flag, qual, strand, xs, ts, isize, qlen, hi);
+			qname, pos, rpos, mpos, sstr.str().c_str(), flag, qual, strand, xs, ts, isize, qlen, hi);
 
 	printf(" start position (%d - )\n", pos);
-	for(int i = 0; i < spos.size(); i++)
+	for(int i = 0; i < n_spos; i++)
 	{
 		int64_t p = spos[i];
 		int32_t p1 = high32(p);
@@ -248,6 +317,12 @@ int hit::get_mid_intervals(vector<int64_t> &vm, vector<int64_t> &vi, vector<int6
 	vm.clear();
 	vi.clear();
 	vd.clear();
+	return add_mid_intervals(vm, vi, vd);
+}
+
+int hit::add_mid_intervals(vector<int64_t> &vm, vector<int64_t> &vi, vector<int64_t> &vd) const
+{
+	// append without clearing
 	int32_t p = pos;
     for(int k = 0; k < n_cigar; k++)
 	{
@@ -12,6 +12,7 @@ See LICENSE for licensing.
 
 #include "htslib/sam.h"
 #include "config.h"
+#include "arena.h"
 
 using namespace std;
 
@@ -46,15 +47,11 @@ class hit: public bam1_core_t
 public:
 	//hit(int32_t p);
 	hit(bam1_t *b);
-	hit(const hit &h);
-	~hit();
 	bool operator<(const hit &h) const;
-	hit& operator=(const hit &h);
 
 public:
 	int32_t rpos;							// right position mapped to reference [pos, rpos)
 	int32_t qlen;							// read length
-	string qname;							// query name
 	char strand;							// strandness
 	char xs;								// XS aux in sam
 	char ts;								// ts tag used in minimap2
@@ -62,19 +59,46 @@ public:
 	int32_t hi;								// HI aux in sam
 	int32_t nm;								// NM aux in sam
 	bool concordant;						// whether it is concordant
+	bool spliced;							// whether cigar has a skip (N)
+	int32_t n_spos;							// number of splice positions
+	uint64_t qhash;							// hash of query name
+	int32_t weight;							// number of identical reads this hit stands for
+	char* qname;							// query name
 	uint32_t* cigar;						// cigar, use samtools
-	vector<int64_t> spos;					// splice positions
+	int64_t* spos;							// splice positions
+
+	// qname and cigar point into the bam1_t the hit is built from,
+	// until attach() moves them (with spos) into an arena
 
 public:
+	int attach(arena &a);
 	int set_tags(bam1_t *b);
 	int set_strand();
 	int set_concordance();
-	int build_splice_positions();
+	int build_splice_positions(arena &a);
 	int get_mid_intervals(vector<int64_t> &vm, vector<int64_t> &vi, vector<int64_t> &vd) const;
+	int add_mid_intervals(vector<int64_t> &vm, vector<int64_t> &vi, vector<int64_t> &vd) const;
 	int get_matched_intervals(vector<int64_t> &v) const;
+	uint64_t alignment_hash() const;
+	bool same_alignment(const hit &h) const;
 	int print() const;
 };
 
 //inline bool hit_compare_by_name(const hit &x, const hit &y);
 
+// compare hits given by their indices in a vector
+class hit_index_compare
+{
+public:
+	hit_index_compare(const vector<hit> &v) : hits(v) {}
+	bool operator()(int x, int y) const { return hits[x] < hits[y]; }
+
+private:
+	const vector<hit> &hits;
+};
+
+// order the indices of hits such that the alignments of each read are
+// consecutive, and ordered by hit::operator< within the read
+int group_by_name(const vector<hit> &hits, vector<int> &order);
+
 #endif
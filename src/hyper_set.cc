@@ -9,15 +9,35 @@ See LICENSE for licensing.
 #include <algorithm>
 #include <cstdio>
 
+hyper_set::hyper_set()
+{
+	clear();
+}
+
 int hyper_set::clear()
 {
-	nodes.clear();
+	nv.clear();
+	np.assign(1, 0);
+	nc.clear();
+	nh.clear();
 	edges.clear();
 	e2s.clear();
 	ecnts.clear();
 	return 0;
 }
 
+int hyper_set::swap(hyper_set &hs)
+{
+	nv.swap(hs.nv);
+	np.swap(hs.np);
+	nc.swap(hs.nc);
+	nh.swap(hs.nh);
+	edges.swap(hs.edges);
+	ecnts.swap(hs.ecnts);
+	e2s.swap(hs.e2s);
+	return 0;
+}
+
 int hyper_set::add_node_list(const set<int> &s)
 {
 	return add_node_list(s, 1);
@@ -25,44 +45,100 @@ int hyper_set::add_node_list(const set<int> &s)
 
 int hyper_set::add_node_list(const set<int> &s, int c)
 {
-	vector<int> v(s.begin(), s.end());
-	return add_node_list(v, c);
+	// append to the arena; insert_node_list drops it if seen before
+	for(set<int>::const_iterator it = s.begin(); it != s.end(); it++) nv.push_back(*it + 1);
+	return insert_node_list(c);
 }
 
 int hyper_set::add_node_list(const vector<int> &s, int c)
 {
-	vector<int> v = s;
-	sort(v.begin(), v.end());
-	for(int i = 0; i < v.size(); i++) v[i]++;
-	if(nodes.find(v) == nodes.end()) nodes.insert(PVII(v, c));
-	else nodes[v] += c;
+	int p = nv.size();
+	for(int i = 0; i < s.size(); i++) nv.push_back(s[i] + 1);
+	sort(nv.begin() + p, nv.end());
+	return insert_node_list(c);
+}
+
+int hyper_set::num_node_lists() const
+{
+	return np.size() - 1;
+}
+
+int hyper_set::insert_node_list(int c)
+{
+	// the new list is nv[np.back()] ... nv.back()
+	int n = num_node_lists();
+	if(2 * (n + 1) > nh.size()) rehash(n + 1);
+
+	int p = np.back();
+	size_t m = nh.size() - 1;
+	for(size_t i = hash_node_list(n) & m; true; i = (i + 1) & m)
+	{
+		int k = nh[i];
+		if(k == -1)
+		{
+			nh[i] = n;
+			np.push_back(nv.size());
+			nc.push_back(c);
+			return 0;
+		}
+
+		if(np[k + 1] - np[k] != nv.size() - p) continue;
+		if(equal(nv.begin() + np[k], nv.begin() + np[k + 1], nv.begin() + p) == false) continue;
+
+		nc[k] += c;
+		nv.resize(p);
+		return 0;
+	}
 	return 0;
 }
 
-int hyper_set::build(directed_graph &gr, MEI& e2i)
+int hyper_set::rehash(int n)
+{
+	size_t m = 16;
+	while(m < 2 * n) m *= 2;
+	nh.assign(m, -1);
+	m--;
+	for(int k = 0; k < num_node_lists(); k++)
+	{
+		size_t i = hash_node_list(k) & m;
+		while(nh[i] != -1) i = (i + 1) & m;
+		nh[i] = k;
+	}
+	return 0;
+}
+
+size_t hyper_set::hash_node_list(int k) const
+{
+	int b = np[k];
+	int e = (k + 1 < np.size()) ? np[k + 1] : nv.size();
+	size_t h = 0;
+	for(int i = b; i < e; i++) h = h * 1000003 + nv[i];
+	return h ^ (h >> 29);
+}
+
+int hyper_set::build(directed_graph &gr, const vector<int> &e2i)
 {
 	build_edges(gr, e2i);
 	build_index();
 	return 0;
 }
 
-int hyper_set::build_edges(directed_graph &gr, MEI& e2i)
+int hyper_set::build_edges(directed_graph &gr, const vector<int> &e2i)
 {
 	edges.clear();
-	for(MVII::iterator it = nodes.begin(); it != nodes.end(); it++)
+	for(int i = 0; i < num_node_lists(); i++)
 	{
-		int c = it->second;
+		int c = nc[i];
 		if(c < min_router_count) continue;
 
-		const vector<int> &vv = it->first;
 		vector<int> ve;
 		bool b = true;
-		for(int k = 0; k < vv.size() - 1; k++)
+		for(int k = np[i]; k < np[i + 1] - 1; k++)
 		{
-			PEB p = gr.edge(vv[k], vv[k + 1]);
+			PEB p = gr.edge(nv[k], nv[k + 1]);
 			if(p.second == false) b = false;
 			if(p.second == false) ve.push_back(-1);
-			else ve.push_back(e2i[p.first]);
+			else ve.push_back(e2i[p.first->index()]);
 		}
 
 		if(b == true && ve.size() >= 2)
@@ -98,6 +174,33 @@ int hyper_set::build_edges(directed_graph &gr, MEI& e2i)
 	return 0;
 }
 
+bool hyper_set::find_index(int e) const
+{
+	if(e < 0 || e >= e2s.size()) return false;
+	if(e2s[e].size() == 0) return false;
+	return true;
+}
+
+int hyper_set::add_index(int e, int k)
+{
+	if(e >= e2s.size()) e2s.resize(e + 1);
+	vector<int> &s = e2s[e];
+	vector<int>::iterator it = lower_bound(s.begin(), s.end(), k);
+	if(it != s.end() && (*it) == k) return 0;
+	s.insert(it, k);
+	return 0;
+}
+
+int hyper_set::remove_index(int e, int k)
+{
+	if(e < 0 || e >= e2s.size()) return 0;
+	vector<int> &s = e2s[e];
+	vector<int>::iterator it = lower_bound(s.begin(), s.end(), k);
+	if(it == s.end() || (*it) != k) return 0;
+	s.erase(it);
+	return 0;
+}
+
 int hyper_set::build_index()
 {
 	e2s.clear();
@@ -108,16 +211,7 @@ int hyper_set::build_index()
 		{
 			int e = v[j];
 			if(e == -1) continue;
-			if(e2s.find(e) == e2s.end())
-			{
-				set<int> s;
-				s.insert(i);
-				e2s.insert(PISI(e, s));
-			}
-			else
-			{
-				e2s[e].insert(i);
-			}
+			add_index(e, i);
 		}
 	}
 	return 0;
@@ -125,48 +219,44 @@ int hyper_set::build_index()
 
 int hyper_set::update_index()
 {
-	vector<int> fb1;
-	for(MISI::iterator p = e2s.begin(); p != e2s.end(); p++)
+	for(int e = 0; e < e2s.size(); e++)
 	{
-		int e = p->first;
-		set<int> &ss = p->second;
+		vector<int> &ss = e2s[e];
 		vector<int> fb2;
-		for(set<int>::iterator it = ss.begin(); it != ss.end(); it++)
+		for(int j = 0; j < ss.size(); j++)
 		{
-			vector<int> &v = edges[*it];
+			vector<int> &v = edges[ss[j]];
 			for(int i = 0; i < v.size(); i++)
 			{
 				if(v[i] != e) continue;
 				bool b1 = false, b2 = false;
 				if(i == 0 || v[i - 1] == -1) b1 = true;
 				if(i == v.size() - 1 || v[i + 1] == -1) b2 = true;
-				if(b1 == true && b2 == true) fb2.push_back(*it);
+				if(b1 == true && b2 == true) fb2.push_back(ss[j]);
 				break;
 			}
 		}
-		for(int i = 0; i < fb2.size(); i++) ss.erase(fb2[i]);
-		if(ss.size() == 0) fb1.push_back(e);
+		for(int i = 0; i < fb2.size(); i++) remove_index(e, fb2[i]);
 	}
-	for(int i = 0; i < fb1.size(); i++) e2s.erase(fb1[i]);
 	return 0;
 }
 
-set<int> hyper_set::get_intersection(const vector<int> &v)
+vector<int> hyper_set::get_intersection(const vector<int> &v)
 {
-	set<int> ss;
+	vector<int> ss;
 	if(v.size() == 0) return ss;
 	assert(v[0] >= 0);
-	if(e2s.find(v[0]) == e2s.end()) return ss;
+	if(find_index(v[0]) == false) return ss;
 	ss = e2s[v[0]];
-	vector<int> vv(ss.size());
 	for(int i = 1; i < v.size(); i++)
 	{
 		assert(v[i] >= 0);
-		set<int> s;
-		if(e2s.find(v[i]) == e2s.end()) return s;
-		s = e2s[v[i]];
+		if(find_index(v[i]) == false) return vector<int>();
+		const vector<int> &s = e2s[v[i]];
+		vector<int> vv(ss.size());
 		vector<int>::iterator it = set_intersection(ss.begin(), ss.end(), s.begin(), s.end(), vv.begin());
-		ss = set<int>(vv.begin(), it);
+		vv.resize(it - vv.begin());
+		ss.swap(vv);
 	}
 	return ss;
 }
@@ -174,12 +264,12 @@ set<int> hyper_set::get_intersection(const vector<int> &v)
 MI hyper_set::get_successors(int e)
 {
 	MI s;
-	if(e2s.find(e) == e2s.end()) return s;
-	set<int> &ss = e2s[e];
-	for(set<int>::iterator it = ss.begin(); it != ss.end(); it++)
+	if(find_index(e) == false) return s;
+	const vector<int> &ss = e2s[e];
+	for(int j = 0; j < ss.size(); j++)
 	{
-		vector<int> &v = edges[*it];
-		int c = ecnts[*it];
+		vector<int> &v = edges[ss[j]];
+		int c = ecnts[ss[j]];
 		for(int i = 0; i < v.size(); i++)
 		{
 			if(v[i] != e) continue;
@@ -196,12 +286,12 @@ MI hyper_set::get_successors(int e)
 MI hyper_set::get_predecessors(int e)
 {
 	MI s;
-	if(e2s.find(e) == e2s.end()) return s;
-	set<int> &ss = e2s[e];
-	for(set<int>::iterator it = ss.begin(); it != ss.end(); it++)
+	if(find_index(e) == false) return s;
+	const vector<int> &ss = e2s[e];
+	for(int j = 0; j < ss.size(); j++)
 	{
-		vector<int> &v = edges[*it];
-		int c = ecnts[*it];
+		vector<int> &v = edges[ss[j]];
+		int c = ecnts[ss[j]];
 		for(int i = 0; i < v.size(); i++)
 		{
 			if(v[i] != e) continue;
@@ -215,7 +305,7 @@ MI hyper_set::get_predecessors(int e)
 	return s;
 }
 
-MPII hyper_set::get_routes(int x, directed_graph &gr, MEI &e2i)
+MPII hyper_set::get_routes(int x, directed_graph &gr, const vector<int> &e2i)
 {
 	MPII mpi;
 	edge_iterator it1, it2;
@@ -223,8 +313,8 @@ MPII hyper_set::get_routes(int x, directed_graph &gr, MEI &e2i)
 	vector<PI> v;
 	for(pei = gr.in_edges(x), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
 	{
-		assert(e2i.find(*it1) != e2i.end());
-		int e = e2i[*it1];
+		int e = e2i[(*it1)->index()];
+		assert(e != -1);
 		MI s = get_successors(e);
 		for(MI::iterator it = s.begin(); it != s.end(); it++)
 		{
@@ -291,12 +381,12 @@ int hyper_set::replace(int x, int y, int e)
 int hyper_set::replace(const vector<int> &v, int e)
 {
 	if(v.size() == 0) return 0;
-	set<int> s = get_intersection(v);
+	vector<int> s = get_intersection(v);
 	
 	vector<int> fb;
-	for(set<int>::iterator it = s.begin(); it != s.end(); it++)
+	for(int j = 0; j < s.size(); j++)
 	{
-		int k = (*it);
+		int k = s[j];
 		vector<int> &vv = edges[k];
 		vector<int> bv = consecutive_subset(vv, v);
 
@@ -317,24 +407,12 @@ int hyper_set::replace(const vector<int> &v, int e)
 
 		vv.erase(vv.begin() + b + 1, vv.begin() + b + v.size());
 
-		if(e2s.find(e) == e2s.end())
-		{
-			set<int> ss;
-			ss.insert(k);
-			e2s.insert(PISI(e, ss));
-		}
-		else
-		{
-			e2s[e].insert(k);
-		}
+		add_index(e, k);
 	}
 
 	for(int i = 0; i < v.size(); i++)
 	{
-		int u = v[i];
-		if(e2s.find(u) == e2s.end()) continue;
-		for(int k = 0; k < fb.size(); k++) e2s[u].erase(fb[k]);
-		if(e2s[u].size() == 0) e2s.erase(u);
+		for(int k = 0; k < fb.size(); k++) remove_index(v[i], fb[k]);
 	}
 	return 0;
 }
@@ -352,42 +430,35 @@ int hyper_set::remove(const vector<int> &v)
 
 int hyper_set::remove(int e)
 {
-	if(e2s.find(e) == e2s.end()) return 0;
-	set<int> &s = e2s[e];
-	vector<int> fb;
-	for(set<int>::iterator it = s.begin(); it != s.end(); it++)
+	if(find_index(e) == false) return 0;
+	vector<int> &s = e2s[e];
+	for(int j = 0; j < s.size(); j++)
 	{
-		int k = (*it);
+		int k = s[j];
 		vector<int> &vv = edges[k];
 		assert(vv.size() >= 1);
 
 		for(int i = 0; i < vv.size(); i++)
 		{
 			if(vv[i] != e) continue;
-
 			vv[i] = -1;
-
-			bool b1 = useful(vv, 0, i - 1);
-			bool b2 = useful(vv, i + 1, vv.size() - 1);
-			if(b1 == false && b2 == false) fb.push_back(k);
-			 
 			break;
 		}
 	}
 
-	for(int i = 0; i < fb.size(); i++) s.erase(fb[i]);
-	e2s.erase(e);
+	// all hyper-edges are dropped from the index of e
+	s.clear();
 	return 0;
 }
 
 int hyper_set::remove_pair(int x, int y)
 {
-	if(e2s.find(x) == e2s.end()) return 0;
-	set<int> &s = e2s[x];
+	if(find_index(x) == false) return 0;
+	const vector<int> &s = e2s[x];
 	vector<int> fb;
-	for(set<int>::iterator it = s.begin(); it != s.end(); it++)
+	for(int j = 0; j < s.size(); j++)
 	{
-		int k = (*it);
+		int k = s[j];
 		vector<int> &vv = edges[k];
 		assert(vv.size() >= 1);
 
@@ -407,8 +478,7 @@ int hyper_set::remove_pair(int x, int y)
 		}
 	}
 
-	for(int i = 0; i < fb.size(); i++) s.erase(fb[i]);
-	if(s.size() == 0) e2s.erase(x);
+	for(int i = 0; i < fb.size(); i++) remove_index(x, fb[i]);
 
 	return 0;
 }
@@ -424,11 +494,11 @@ bool hyper_set::useful(const vector<int> &v, int k1, int k2)
 
 int hyper_set::insert_between(int x, int y, int e)
 {
-	if(e2s.find(x) == e2s.end()) return 0;
-	set<int> s = e2s[x];
-	for(set<int>::iterator it = s.begin(); it != s.end(); it++)
+	if(find_index(x) == false) return 0;
+	vector<int> s = e2s[x];
+	for(int j = 0; j < s.size(); j++)
 	{
-		int k = (*it);
+		int k = s[j];
 		vector<int> &vv = edges[k];
 		assert(vv.size() >= 1);
 
@@ -439,16 +509,7 @@ int hyper_set::insert_between(int x, int y, int e)
 			if(vv[i + 1] != y) continue;
 			vv.insert(vv.begin() + i + 1, e);
 
-			if(e2s.find(e) == e2s.end())
-			{
-				set<int> ss;
-				ss.insert(k);
-				e2s.insert(PISI(e, ss));
-			}
-			else
-			{
-				e2s[e].insert(k);
-			}
+			add_index(e, k);
 
 			//printf("line %d: insert %d between (%d, %d) = (%d, %d, %d)\n", k, e, x, y, vv[i], vv[i + 1], vv[i + 2]);
 
@@ -465,11 +526,11 @@ bool hyper_set::extend(int e)
 
 bool hyper_set::left_extend(int e)
 {
-	if(e2s.find(e) == e2s.end()) return false;
-	set<int> s = e2s[e];
-	for(set<int>::iterator it = s.begin(); it != s.end(); it++)
+	if(find_index(e) == false) return false;
+	const vector<int> &s = e2s[e];
+	for(int j = 0; j < s.size(); j++)
 	{
-		int k = (*it);
+		int k = s[j];
 		vector<int> &vv = edges[k];
 		assert(vv.size() >= 1);
 
@@ -483,11 +544,11 @@ bool hyper_set::left_extend(int e)
 
 bool hyper_set::right_extend(int e)
 {
-	if(e2s.find(e) == e2s.end()) return false;
-	set<int> s = e2s[e];
-	for(set<int>::iterator it = s.begin(); it != s.end(); it++)
+	if(find_index(e) == false) return false;
+	const vector<int> &s = e2s[e];
+	for(int j = 0; j < s.size(); j++)
 	{
-		int k = (*it);
+		int k = s[j];
 		vector<int> &vv = edges[k];
 		assert(vv.size() >= 1);
 
@@ -521,14 +582,14 @@ bool hyper_set::left_dominate(int e)
 {
 	// for each appearance of e
 	// if right is not empty then left is also not empty
-	if(e2s.find(e) == e2s.end()) return true;
+	if(find_index(e) == false) return true;
 
 	set<PI> x1;
 	set<PI> x2;
-	set<int> s = e2s[e];
-	for(set<int>::iterator it = s.begin(); it != s.end(); it++)
+	const vector<int> &s = e2s[e];
+	for(int j = 0; j < s.size(); j++)
 	{
-		int k = (*it);
+		int k = s[j];
 		vector<int> &vv = edges[k];
 		assert(vv.size() >= 1);
 
@@ -562,13 +623,13 @@ bool hyper_set::right_dominate(int e)
 {
 	// for each appearance of e
 	// if left is not empty then right is also not empty
-	if(e2s.find(e) == e2s.end()) return true;
+	if(find_index(e) == false) return true;
 	set<PI> x1;
 	set<PI> x2;
-	set<int> s = e2s[e];
-	for(set<int>::iterator it = s.begin(); it != s.end(); it++)
+	const vector<int> &s = e2s[e];
+	for(int j = 0; j < s.size(); j++)
 	{
-		int k = (*it);
+		int k = s[j];
 		vector<int> &vv = edges[k];
 		assert(vv.size() >= 1);
 		for(int i = 1; i < vv.size(); i++)
@@ -601,11 +662,10 @@ bool hyper_set::right_dominate(int e)
 int hyper_set::print()
 {
 	//printf("PRINT HYPER_SET\n");
-	for(MVII::iterator it = nodes.begin(); it != nodes.end(); it++)
+	for(int i = 0; i < num_node_lists(); i++)
 	{
-		const vector<int> &v = it->first;
-		int c = it->second;
-		printf("hyper-edge (nodes), counts = %d, list = ( ", c); 
+		vector<int> v(nv.begin() + np[i], nv.begin() + np[i + 1]);
+		printf("hyper-edge (nodes), counts = %d, list = ( ", nc[i]); 
 		printv(v);
 		printf(")\n");
 	}
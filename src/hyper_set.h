@@ -16,10 +16,6 @@ See LICENSE for licensing.
 
 using namespace std;
 
-typedef pair<vector<int>, int> PVII;
-typedef map<vector<int>, int> MVII;
-typedef map< int, set<int> > MISI;
-typedef pair< int, set<int> > PISI;
 typedef vector< vector<int> > VVI;
 typedef map< pair<int, int>, int> MPII;
 typedef pair< pair<int, int>, int> PPII;
@@ -27,26 +23,42 @@ typedef pair< pair<int, int>, int> PPII;
 class hyper_set
 {
 public:
-	MVII nodes;			// hyper-edges using list-of-nodes
+	hyper_set();
+
+public:
+	vector<int> nv;		// hyper-edges using list-of-nodes, concatenated
+	vector<int> np;		// list i is nv[np[i]] ... nv[np[i + 1] - 1]
+	vector<int> nc;		// counts for lists of nodes
+	vector<int> nh;		// hash table of lists of nodes, -1 if empty
 	VVI edges;			// hyper-edges using list-of-edges
 	vector<int> ecnts;	// counts for edges
-	MISI e2s;			// index: from edge to hyper-edges
+	VVI e2s;			// index: from edge to hyper-edges, sorted
 
 public:
 	int clear();
+	int swap(hyper_set &hs);
 	int add_node_list(const set<int> &s);
 	int add_node_list(const set<int> &s, int c);
 	int add_node_list(const vector<int> &s, int c);
-	int build(directed_graph &gr, MEI &e2i);
-	int build_edges(directed_graph &gr, MEI &e2i);
+	int num_node_lists() const;
+	int build(directed_graph &gr, const vector<int> &e2i);
+	int build_edges(directed_graph &gr, const vector<int> &e2i);
 	int build_index();
 	int update_index();
-	set<int> get_intersection(const vector<int> &v);
+	vector<int> get_intersection(const vector<int> &v);
 	MI get_successors(int e);
 	MI get_predecessors(int e);
-	MPII get_routes(int x, directed_graph &gr, MEI &e2i);
+	MPII get_routes(int x, directed_graph &gr, const vector<int> &e2i);
 	int print();
 
+private:
+	int insert_node_list(int c);
+	int rehash(int n);
+	size_t hash_node_list(int k) const;
+	bool find_index(int e) const;
+	int add_index(int e, int k);
+	int remove_index(int e, int k);
+
 public:
 	int replace(int x, int e);
 	int replace(int x, int y, int e);
@@ -5,6 +5,8 @@ See LICENSE for licensing.
 */
 
 #include "interval_map.h"
+#include "util.h"
+#include <algorithm>
 
 int create_split(split_interval_map &imap, int32_t p)
 {
@@ -22,6 +24,71 @@ int create_split(split_interval_map &imap, int32_t p)
 	return 0;
 }
 
+int add_intervals(split_interval_map &imap, const vector<int64_t> &v)
+{
+	// equivalent to imap += make_pair(ROI(s, t), 1) for each interval,
+	// as a split map keeps a boundary at every endpoint that was added
+	vector<int32_t> s;
+	vector<int32_t> t;
+	s.reserve(v.size());
+	t.reserve(v.size());
+	for(int i = 0; i < v.size(); i++)
+	{
+		int32_t l = high32(v[i]);
+		int32_t r = low32(v[i]);
+		if(l >= r) continue;
+		s.push_back(l);
+		t.push_back(r);
+	}
+	sort(s.begin(), s.end());
+	sort(t.begin(), t.end());
+
+	split_interval_map::iterator it = imap.begin();
+	int i = 0, j = 0, c = 0;
+	int32_t p = 0;
+	while(j < t.size())
+	{
+		int32_t x = (i < s.size() && s[i] < t[j]) ? s[i] : t[j];
+		if(c >= 1 && x > p) it = imap.add(it, make_pair(ROI(p, x), c));
+		while(i < s.size() && s[i] == x) c++, i++;
+		while(j < t.size() && t[j] == x) c--, j++;
+		p = x;
+	}
+	return 0;
+}
+
+int add_intervals(split_interval_map &imap, const vector<int64_t> &v, const vector<int> &w)
+{
+	assert(v.size() == w.size());
+	vector< pair<int32_t, int> > s;
+	vector< pair<int32_t, int> > t;
+	s.reserve(v.size());
+	t.reserve(v.size());
+	for(int i = 0; i < v.size(); i++)
+	{
+		int32_t l = high32(v[i]);
+		int32_t r = low32(v[i]);
+		if(l >= r) continue;
+		s.push_back(pair<int32_t, int>(l, w[i]));
+		t.push_back(pair<int32_t, int>(r, w[i]));
+	}
+	sort(s.begin(), s.end());
+	sort(t.begin(), t.end());
+
+	split_interval_map::iterator it = imap.begin();
+	int i = 0, j = 0, c = 0;
+	int32_t p = 0;
+	while(j < t.size())
+	{
+		int32_t x = (i < s.size() && s[i].first < t[j].first) ? s[i].first : t[j].first;
+		if(c >= 1 && x > p) it = imap.add(it, make_pair(ROI(p, x), c));
+		while(i < s.size() && s[i].first == x) c += s[i].second, i++;
+		while(j < t.size() && t[j].first == x) c -= t[j].second, j++;
+		p = x;
+	}
+	return 0;
+}
+
 int compute_overlap(const split_interval_map &imap, int32_t p)
 {
 	SIMI it = imap.find(p);
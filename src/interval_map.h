@@ -31,6 +31,12 @@ typedef pair<SIMI, SIMI> PSIMI;
 // if p is inside an interval, split this interval into 2
 int create_split(split_interval_map &imap, int32_t p);
 
+// add each interval of v (packed by pack()) with weight 1 using one sweep
+int add_intervals(split_interval_map &imap, const vector<int64_t> &v);
+
+// as above, but add the i-th interval of v with weight w[i]
+int add_intervals(split_interval_map &imap, const vector<int64_t> &v, const vector<int> &w);
+
 // return the overlap at position p
 int compute_overlap(const split_interval_map &imap, int32_t p);
 
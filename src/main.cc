@@ -47,9 +47,14 @@ int main(int argc, const char **argv)
 	{
 		previewer pv;
 		pv.preview();
-	}
 
-	if(preview_only == true) return 0;
+		if(preview_only == true) return 0;
+
+		// reuse the previewed reads and the opened input
+		assembler asmb(pv);
+		asmb.assemble();
+		return 0;
+	}
 
 	assembler asmb;
 	asmb.assemble();
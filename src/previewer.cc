@@ -14,6 +14,15 @@ See LICENSE for licensing.
 previewer::previewer()
 {
     sfn = sam_open(input_file.c_str(), "r");
+
+	tpool = NULL;
+	if(decode_threads >= 1)
+	{
+		tpool = hts_tpool_init(decode_threads);
+		htsThreadPool p = {tpool, 0};
+		hts_set_thread_pool(sfn, &p);
+	}
+
     hdr = sam_hdr_read(sfn);
     b1t = bam_init1();
 }
@@ -21,8 +30,11 @@ previewer::previewer()
 previewer::~previewer()
 {
     bam_destroy1(b1t);
-    bam_hdr_destroy(hdr);
-    sam_close(sfn);
+
+	// the input may have been handed over to the assembler
+	if(hdr != NULL) bam_hdr_destroy(hdr);
+	if(sfn != NULL) sam_close(sfn);
+	if(tpool != NULL) hts_tpool_destroy(tpool);
 }
 
 int previewer::preview()
@@ -36,10 +48,13 @@ int previewer::preview()
 	vector<int> sp1;
 	vector<int> sp2;
 
-    while(sam_read1(sfn, hdr, b1t) >= 0)
+	// stop before reading a record that would not be previewed
+	// so that the assembler can continue from the next one
+	while(true)
 	{
 		if(total >= max_preview_reads) break;
 		if(sp1.size() >= max_preview_spliced_reads && sp2.size() >= max_preview_spliced_reads) break;
+		if(sam_read1(sfn, hdr, b1t) < 0) break;
 
 		bam1_core_t &p = b1t->core;
 
@@ -54,6 +69,9 @@ int previewer::preview()
 		hit ht(b1t);
 		ht.set_tags(b1t);
 
+		if(preview_only == false) hits.push_back(ht);
+		if(preview_only == false) hits.back().attach(hdata);
+
 		if((ht.flag & 0x1) >= 1) paired ++;
 		if((ht.flag & 0x1) <= 0) single ++;
 
@@ -8,9 +8,11 @@ See LICENSE for licensing.
 #define __PREVIEWER_H__
 
 #include "hit.h"
+#include "htslib/thread_pool.h"
 
 #include <fstream>
 #include <string>
+#include <vector>
 
 using namespace std;
 
@@ -20,9 +22,14 @@ public:
 	previewer();
 	~previewer();
 
-private:
+public:
 	samFile *sfn;
 	bam_hdr_t *hdr;
+	hts_tpool *tpool;
+	vector<hit> hits;		// previewed hits, to be replayed by the assembler
+	arena hdata;			// data of previewed hits
+
+private:
 	bam1_t *b1t;
 
 public:
@@ -11,8 +11,8 @@ See LICENSE for licensing.
 
 using namespace std;
 
-region::region(int32_t _lpos, int32_t _rpos, int _ltype, int _rtype, const split_interval_map *_mmap, const split_interval_map *_imap)
-	:lpos(_lpos), rpos(_rpos), mmap(_mmap), imap(_imap), ltype(_ltype), rtype(_rtype)
+region::region(int32_t _lpos, int32_t _rpos, int _ltype, int _rtype, const split_interval_map *_mmap, const split_interval_map *_imap, const coverage_index *_mindex)
+	:lpos(_lpos), rpos(_rpos), mmap(_mmap), imap(_imap), mindex(_mindex), ltype(_ltype), rtype(_rtype)
 {
 
 	build_join_interval_map();
@@ -28,18 +28,12 @@ int region::build_join_interval_map()
 {
 	jmap.clear();
 
-	PSIMI pei = locate_boundary_iterators(*mmap, lpos, rpos);
-	SIMI lit = pei.first, rit = pei.second;
-
-	if(lit == mmap->end() || rit == mmap->end()) return 0;
-
-	SIMI it = lit;
-	while(true)
+	// adding each segment of mmap inside the region with 1 joins touching ones
+	vector<PI32> v;
+	mindex->get_joint_intervals(lpos, rpos, v);
+	for(int i = 0; i < v.size(); i++)
 	{
-		//if(it->second >= 2) 
-		jmap += make_pair(it->first, 1);
-		if(it == rit) break;
-		it++;
+		jmap += make_pair(ROI(v[i].first, v[i].second), 1);
 	}
 
 	for(JIMI it = jmap.begin(); it != jmap.end(); it++)
@@ -141,11 +135,10 @@ bool region::empty_subregion(int32_t p1, int32_t p2)
 	//printf(" region = [%d, %d), subregion [%d, %d), length = %d\n", lpos, rpos, p1, p2, p2 - p1);
 	if(p2 - p1 < min_subregion_length) return true;
 
-	PSIMI pei = locate_boundary_iterators(*mmap, p1, p2);
-	SIMI it1 = pei.first, it2 = pei.second;
-	if(it1 == mmap->end() || it2 == mmap->end()) return true;
+	int i, j;
+	if(mindex->locate(p1, p2, i, j) == false) return true;
 
-	int32_t sum = compute_sum_overlap(*mmap, it1, it2);
+	int32_t sum = mindex->compute_sum_overlap(p1, p2);
 	double ratio = sum * 1.0 / (p2 - p1);
 	//printf(" region = [%d, %d), subregion [%d, %d), overlap = %.2lf\n", lpos, rpos, p1, p2, ratio);
 	//if(ratio < min_subregion_overlap + max_intron_contamination_coverage) return true;
@@ -165,7 +158,7 @@ int region::build_partial_exons()
 	if(lower(jmap.begin()->first) == lpos && upper(jmap.begin()->first) == rpos)
 	{
 		partial_exon pe(lpos, rpos, ltype, rtype);
-		evaluate_rectangle(*mmap, pe.lpos, pe.rpos, pe.ave, pe.dev);
+		mindex->evaluate_rectangle(pe.lpos, pe.rpos, pe.ave, pe.dev);
 		pexons.push_back(pe);
 		return 0;
 	}
@@ -197,7 +190,7 @@ int region::build_partial_exons()
 		int rt = (p2 == rpos) ? rtype : END_BOUNDARY;
 
 		partial_exon pe(p1, p2, lt, rt);
-		evaluate_rectangle(*mmap, pe.lpos, pe.rpos, pe.ave, pe.dev);
+		mindex->evaluate_rectangle(pe.lpos, pe.rpos, pe.ave, pe.dev);
 		pexons.push_back(pe);
 	}
 
@@ -11,6 +11,7 @@ See LICENSE for licensing.
 #include <vector>
 #include "interval_map.h"
 #include "partial_exon.h"
+#include "coverage_index.h"
 
 using namespace std;
 
@@ -19,7 +20,7 @@ typedef pair<int, int> PI;
 class region
 {
 public:
-	region(int32_t _lpos, int32_t _rpos, int _ltype, int _rtype, const split_interval_map *_mmap, const split_interval_map *_imap);
+	region(int32_t _lpos, int32_t _rpos, int _ltype, int _rtype, const split_interval_map *_mmap, const split_interval_map *_imap, const coverage_index *_mindex);
 	~region();
 
 public:
@@ -29,6 +30,7 @@ public:
 	int rtype;						// type of the right boundary
 	const split_interval_map *mmap;	// pointer to match interval map
 	const split_interval_map *imap;	// pointer to indel interval map
+	const coverage_index *mindex;	// pointer to the flat index of mmap
 	join_interval_map jmap;			// subregion intervals
 
 	vector<partial_exon> pexons;	// generated partial exons
@@ -21,12 +21,12 @@ See LICENSE for licensing.
 #include <cfloat>
 #include <stdint.h>
 
-router::router(int r, splice_graph &g, MEI &ei, VE &ie)
+router::router(int r, splice_graph &g, vector<int> &ei, VE &ie)
 	:root(r), gr(g), e2i(ei), i2e(ie), degree(-1), type(-1)
 {
 }
 
-router::router(int r, splice_graph &g, MEI &ei, VE &ie, const MPII &mpi)
+router::router(int r, splice_graph &g, vector<int> &ei, VE &ie, const MPII &mpi)
 	:root(r), gr(g), e2i(ei), i2e(ie), degree(-1), type(-1)
 {
 	routes.clear();
@@ -151,20 +151,28 @@ int router::build_indices()
 	PEEI pei;
 	for(pei = gr.in_edges(root), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
 	{
-		int e = e2i[*it1];
-		e2u.insert(PI(e, e2u.size()));
+		int e = e2i[(*it1)->index()];
+		e2u.push_back(PI(e, e2u.size()));
 		u2e.push_back(e);
 	}
 	for(pei = gr.out_edges(root), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
 	{
-		int e = e2i[*it1];
-		e2u.insert(PI(e, e2u.size()));
+		int e = e2i[(*it1)->index()];
+		e2u.push_back(PI(e, e2u.size()));
 		u2e.push_back(e);
 	}
+	sort(e2u.begin(), e2u.end());
 
 	return 0;
 }
 
+int router::locate_edge(int e) const
+{
+	vector<PI>::const_iterator it = lower_bound(e2u.begin(), e2u.end(), PI(e, -1));
+	if(it == e2u.end() || it->first != e) return -1;
+	return it->second;
+}
+
 int router::build_bipartite_graph()
 {
 	ug.clear();
@@ -174,15 +182,16 @@ int router::build_bipartite_graph()
 	{
 		int e1 = routes[i].first;
 		int e2 = routes[i].second;
-		assert(e2u.find(e1) != e2u.end());
-		assert(e2u.find(e2) != e2u.end());
-		int s = e2u[e1];
-		int t = e2u[e2];
+		int s = locate_edge(e1);
+		int t = locate_edge(e2);
+		assert(s != -1);
+		assert(t != -1);
 		assert(s >= 0 && s < gr.in_degree(root));
 		assert(t >= gr.in_degree(root) && t < gr.degree(root));
 		edge_descriptor e = ug.add_edge(s, t);
 		double w = counts[i];
-		u2w.insert(PED(e, w));
+		u2w.resize(ug.num_edge_indices(), -1);
+		u2w[e->index()] = w;
 	}
 	return 0;
 }
@@ -195,8 +204,8 @@ int router::extend_bipartite_graph_max()
 	int k1 = -1, k2 = -1;
 	for(int i = 0; i < u2e.size(); i++)
 	{
-		if(u2e[i] == e2i[e1]) k1 = i;
-		if(u2e[i] == e2i[e2]) k2 = i;
+		if(u2e[i] == e2i[e1->index()]) k1 = i;
+		if(u2e[i] == e2i[e2->index()]) k2 = i;
 	}
 	assert(k1 != -1 && k2 != -1);
 
@@ -211,6 +220,7 @@ int router::extend_bipartite_graph_max()
 		if(ug.degree(j) >= 1) continue;
 		ug.add_edge(k1, j);
 	}
+	u2w.resize(ug.num_edge_indices(), -1);
 	return 0;
 }
 
@@ -235,13 +245,21 @@ int router::extend_bipartite_graph_all()
 			ug.add_edge(k, j);
 		}
 	}
+	u2w.resize(ug.num_edge_indices(), -1);
 	return 0;
 }
 
 int router::build_maximum_spanning_tree()
 {
 	if(ug.num_vertices() == 0) return 0;
-	vector<PED> vew(u2w.begin(), u2w.end());
+	vector<PED> vew;
+	PEEI pei = ug.edges();
+	for(edge_iterator it = pei.first; it != pei.second; it++)
+	{
+		double w = u2w[(*it)->index()];
+		if(w < 0) continue;
+		vew.push_back(PED(*it, w));
+	}
 	sort(vew.begin(), vew.end(), compare_edge_weight);
 	set<int> sv;
 	sv.insert(0);
@@ -291,8 +309,8 @@ int router::build_maximum_spanning_tree()
 	{
 		edge_descriptor e = vew[i].first;
 		if(se.find(e) != se.end()) continue;
+		u2w[e->index()] = -1;
 		ug.remove_edge(e);
-		u2w.erase(e);
 	}
 	return 0;
 }
@@ -343,8 +361,8 @@ PI router::filter_small_hyper_edge()
 	return p;
 	// TODO, bug here
 	/*
-	printf("edge from (%d, %d) -> (%d, %d)\n", p.first, p.second, e2u[p.first], e2u[p.second]);
-	PEB e = ug.edge(e2u[p.first], e2u[p.second]);
+	printf("edge from (%d, %d) -> (%d, %d)\n", p.first, p.second, locate_edge(p.first), locate_edge(p.second));
+	PEB e = ug.edge(locate_edge(p.first), locate_edge(p.second));
 	assert(e.second == true);
 	ug.remove_edge(e.first);
 	*/
@@ -515,12 +533,12 @@ int router::split()
 		sum1 = sum2 = 0;
 		for(int i = 0; i < eqn1.s.size(); i++)
 		{
-			int e = e2u[eqn1.s[i]];
+			int e = locate_edge(eqn1.s[i]);
 			sum1 += vw[e];
 		}
 		for(int i = 0; i < eqn1.t.size(); i++)
 		{
-			int e = e2u[eqn1.t[i]];
+			int e = locate_edge(eqn1.t[i]);
 			sum2 += vw[e];
 		}
 		eqn1.e = fabs(sum1 - sum2) / sum;
@@ -727,18 +745,18 @@ int router::decompose1_clp()
 	wsum = wsum * 0.5;
 
 	double rsum = 0;
-	for(MED::iterator it = u2w.begin(); it != u2w.end(); it++)
+	PEEI pe = ug.edges();
+	for(edge_iterator it = pe.first; it != pe.second; it++)
 	{
-		double w = it->second;
+		double w = u2w[(*it)->index()];
+		if(w < 0) continue;
 		rsum += w;
 	}
-	MED md;
-	for(MED::iterator it = u2w.begin(); it != u2w.end(); it++)
+	vector<double> md(u2w.size(), -1);
+	for(int k = 0; k < u2w.size(); k++)
 	{
-		edge_descriptor e = it->first;
-		double w = it->second;
-		double ww = w / rsum * wsum;
-		md.insert(PED(e, ww));
+		if(u2w[k] < 0) continue;
+		md[k] = u2w[k] / rsum * wsum;
 	}
 
 	// edge list of ug
@@ -803,8 +821,8 @@ int router::decompose1_clp()
 		for(int i = 0; i < ve.size(); i++)
 		{
 			edge_descriptor e = ve[i];
-			if(md.find(e) == md.end()) continue;
-			double w = md[e];
+			double w = md[e->index()];
+			if(w < 0) continue;
 			vector<int> index2;
 			vector<double> value2;
 			index2.push_back(offset1 + i);
@@ -816,8 +834,8 @@ int router::decompose1_clp()
 		for(int i = 0; i < ve.size(); i++)
 		{
 			edge_descriptor e = ve[i];
-			if(md.find(e) == md.end()) continue;
-			double w = md[e];
+			double w = md[e->index()];
+			if(w < 0) continue;
 			vector<int> index2;
 			vector<double> value2;
 			index2.push_back(offset1 + i);
@@ -875,12 +893,13 @@ int router::decompose2_clp()
 	// normalize routes
 	set<int> cs;
 	double rsum = 0;
-	for(MED::iterator it = u2w.begin(); it != u2w.end(); it++)
+	PEEI pe = ug.edges();
+	for(edge_iterator it = pe.first; it != pe.second; it++)
 	{
-		edge_descriptor e = it->first;
-		double w = it->second;
-		int s = e->source();
-		int t = e->target();
+		double w = u2w[(*it)->index()];
+		if(w < 0) continue;
+		int s = (*it)->source();
+		int t = (*it)->target();
 		cs.insert(s);
 		cs.insert(t);
 		rsum += w;
@@ -899,13 +918,11 @@ int router::decompose2_clp()
 	}
 	double wsum = (wsum1 < wsum2) ? wsum1 : wsum2;
 
-	MED md;
-	for(MED::iterator it = u2w.begin(); it != u2w.end(); it++)
+	vector<double> md(u2w.size(), -1);
+	for(int k = 0; k < u2w.size(); k++)
 	{
-		edge_descriptor e = it->first;
-		double w = it->second;
-		double ww = w / rsum * wsum;
-		md.insert(PED(e, ww));
+		if(u2w[k] < 0) continue;
+		md[k] = u2w[k] / rsum * wsum;
 	}
 
 	// edge list of ug
@@ -988,8 +1005,8 @@ int router::decompose2_clp()
 		for(int i = 0; i < ve.size(); i++)
 		{
 			edge_descriptor e = ve[i];
-			if(md.find(e) == md.end()) continue;
-			double w = md[e];
+			double w = md[e->index()];
+			if(w < 0) continue;
 			vector<int> index2;
 			vector<double> value2;
 			index2.push_back(offset1 + i);
@@ -1001,8 +1018,8 @@ int router::decompose2_clp()
 		for(int i = 0; i < ve.size(); i++)
 		{
 			edge_descriptor e = ve[i];
-			if(md.find(e) == md.end()) continue;
-			double w = md[e];
+			double w = md[e->index()];
+			if(w < 0) continue;
 			vector<int> index2;
 			vector<double> value2;
 			index2.push_back(offset1 + i);
@@ -1064,7 +1081,7 @@ int router::decompose2_clp()
 			int es = u2e[s];
 			int et = u2e[t];
 			double w = opt[offset1 + i];
-			if(u2w.find(e) != u2w.end())
+			if(u2w[e->index()] >= 0)
 			{
 				PI p(es, et);
 				if(s > t) p = PI(et, es);
@@ -24,21 +24,21 @@ using namespace std;
 class router
 {
 public:
-	router(int r, splice_graph &g, MEI &ei, VE &ie);
-	router(int r, splice_graph &g, MEI &ei, VE &ie, const MPII &mpi);
+	router(int r, splice_graph &g, vector<int> &ei, VE &ie);
+	router(int r, splice_graph &g, vector<int> &ei, VE &ie, const MPII &mpi);
 	router& operator=(const router &rt);
 
 public:
 	int root;					// central vertex
 	splice_graph &gr;			// reference splice graph
-	MEI &e2i;					// reference map of edge to index
+	vector<int> &e2i;			// reference map of edge index to index
 	VE &i2e;					// reference map of index to edge
 	vector<PI> routes;			// pairs of connections
 	vector<int> counts;			// counts for routes
 
-	MI e2u;						// edge to index
+	vector<PI> e2u;				// edge to index, sorted pairs
 	vector<int> u2e;			// index to edge
-	MED u2w;					// weights of edges of ug
+	vector<double> u2w;			// weights of edges of ug by edge index, -1 if none
 	undirected_graph ug;		// bipartite graph
 
 	int type;					// trivial, splitable, single, or multiple 
@@ -53,6 +53,7 @@ public:
 	int build();												// give solution
 
 	int build_indices();										// build u2e and e2u
+	int locate_edge(int e) const;								// look up e in e2u
 	int build_bipartite_graph();								// build bipartite graph
 	int extend_bipartite_graph_max();							// extended graph
 	int extend_bipartite_graph_all();							// extended graph
@@ -14,10 +14,20 @@ See LICENSE for licensing.
 #include <algorithm>
 
 scallop::scallop()
+	: log(NULL)
 {}
 
 scallop::scallop(const splice_graph &g, const hyper_set &h)
-	: gr(g), hs(h)
+	: gr(g), hs(h), log(NULL)
+{
+	init();
+}
+
+scallop::~scallop()
+{
+}
+
+int scallop::init()
 {
 	round = 0;
 	if(output_tex_files == true) gr.draw(gr.gid + "." + tostring(round++) + ".tex");
@@ -29,16 +39,19 @@ scallop::scallop(const splice_graph &g, const hyper_set &h)
 	init_vertex_map();
 	init_inner_weights();
 	init_nonzeroset();
-}
-
-scallop::~scallop()
-{
+	return 0;
 }
 
 int scallop::assemble()
 {
 	int c = classify();
-	if(verbose >= 1) printf("process splice graph %s type = %d, vertices = %lu, edges = %lu, phasing paths = %lu\n", gr.gid.c_str(), c, gr.num_vertices(), gr.num_edges(), hs.edges.size());
+	if(verbose >= 1)
+	{
+		char buf[1024];
+		sprintf(buf, "process splice graph %.500s type = %d, vertices = %lu, edges = %lu, phasing paths = %lu\n", gr.gid.c_str(), c, gr.num_vertices(), gr.num_edges(), hs.edges.size());
+		if(log == NULL) printf("%s", buf);
+		else log->append(buf);
+	}
 
 	//resolve_negligible_edges(false, max_decompose_error_ratio[NEGLIGIBLE_EDGE]);
 
@@ -202,18 +215,18 @@ bool scallop::resolve_negligible_edges(bool extend, double max_ratio)
 			edge_descriptor e = (*it1);
 			double w = gr.get_edge_weight(e);
 			if(w > max_ratio * ww1) continue;
-			if(extend && hs.right_extend(e2i[e])) continue;
+			if(extend && hs.right_extend(e2i[e->index()])) continue;
 			if(verbose >= 2) printf("resolve in-negligible edge, degree = (%d, %d), vertex = %d, weight = %.3lf / %.3lf\n", gr.in_degree(i), gr.out_degree(i), i, w, ww1);
-			s.insert(e2i[e]);
+			s.insert(e2i[e->index()]);
 		}
 		for(pei = gr.out_edges(i), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
 		{
 			edge_descriptor e = (*it1);
 			double w = gr.get_edge_weight(e);
 			if(w > max_ratio * ww2) continue;
-			if(extend && hs.left_extend(e2i[e])) continue;
+			if(extend && hs.left_extend(e2i[e->index()])) continue;
 			if(verbose >= 2) printf("resolve out-negligible edge, degree = (%d, %d), vertex = %d, weight = %.3lf / %.3lf\n", gr.in_degree(i), gr.out_degree(i), i, w, ww1);
-			s.insert(e2i[e]);
+			s.insert(e2i[e->index()]);
 		}
 
 		for(set<int>::iterator it = s.begin(); it != s.end(); it++)
@@ -221,7 +234,7 @@ bool scallop::resolve_negligible_edges(bool extend, double max_ratio)
 			edge_descriptor e = i2e[*it];
 			if(gr.out_degree(e->source()) <= 1) continue;
 			if(gr.in_degree(e->target()) <= 1) continue;
-			if(hs.right_extend(e2i[e]) && hs.left_extend(e2i[e])) continue;
+			if(hs.right_extend(e2i[e->index()]) && hs.left_extend(e2i[e->index()])) continue;
 
 			remove_edge(*it);
 			hs.remove(*it);
@@ -341,7 +354,7 @@ bool scallop::resolve_hyper_edge(int fsize)
 	int root = -1;
 	for(pei = gr.edges(), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
 	{
-		int e = e2i[*it1];
+		int e = e2i[(*it1)->index()];
 		int vs = (*it1)->source();
 		int vt = (*it1)->target();
 
@@ -605,7 +618,7 @@ int scallop::add_pseudo_hyper_edges()
 
 int scallop::init_super_edges()
 {
-	mev.clear();
+	mev.assign(gr.num_edge_indices(), vector<int>());
 	edge_iterator it1, it2;
 	PEEI pei;
 	for(pei = gr.edges(), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
@@ -613,7 +626,7 @@ int scallop::init_super_edges()
 		vector<int> v;
 		int s = (*it1)->source();
 		v.push_back(s);
-		mev.insert(PEV(*it1, v));
+		mev[(*it1)->index()] = v;
 	}
 	return 0;
 }
@@ -677,7 +690,7 @@ int scallop::decompose_vertex_extend(int root, MPID &pe2w)
 	for(pei = gr.in_edges(root), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
 	{
 		edge_descriptor e = (*it1);
-		int ei = e2i[e];
+		int ei = e2i[e->index()];
 		int s = e->source();
 		int t = e->target();
 		assert(t == root);
@@ -687,7 +700,7 @@ int scallop::decompose_vertex_extend(int root, MPID &pe2w)
 	for(pei = gr.out_edges(root), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
 	{
 		edge_descriptor e = (*it1);
-		int ei = e2i[e];
+		int ei = e2i[e->index()];
 		int s = e->source();
 		int t = e->target();
 		assert(s == root);
@@ -775,14 +788,14 @@ int scallop::decompose_vertex_extend(int root, MPID &pe2w)
 		
 			int z = i2e.size();
 			i2e.push_back(p);
-			e2i.insert(PEI(p, z));
+			e2i.resize(gr.num_edge_indices(), -1);
+			e2i[p->index()] = z;
 
 			gr.set_edge_weight(p, w);
 			gr.set_edge_info(p, edge_info());
 
-			vector<int> v0;
-			if(mev.find(p) != mev.end()) mev[p] = v0;
-			else mev.insert(PEV(p, v0));
+			mev.resize(gr.num_edge_indices());
+			mev[p->index()] = vector<int>();
 
 			hs.insert_between(e1, e2, z);
 		}
@@ -831,12 +844,12 @@ int scallop::decompose_vertex_replace(int root, MPID &pe2w)
 	PEEI pei;
 	for(pei = gr.in_edges(root), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
 	{
-		int e = e2i[*it1];
+		int e = e2i[(*it1)->index()];
 		assert(md.find(e) != md.end());
 	}
 	for(pei = gr.out_edges(root), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
 	{
-		int e = e2i[*it1];
+		int e = e2i[(*it1)->index()];
 		assert(md.find(e) != md.end());
 	}
 
@@ -897,11 +910,11 @@ int scallop::decompose_trivial_vertex(int x)
 	PEEI pe1, pe2;
 	for(pe1 = gr.in_edges(x), it1 = pe1.first, it2 = pe1.second; it1 != it2; it1++)
 	{
-		int e1 = e2i[*it1];
+		int e1 = e2i[(*it1)->index()];
 		double w1 = gr.get_edge_weight(*it1);
 		for(pe2 = gr.out_edges(x), ot1 = pe2.first, ot2 = pe2.second; ot1 != ot2; ot1++)
 		{
-			int e2 = e2i[*ot1];
+			int e2 = e2i[(*ot1)->index()];
 			double w2 = gr.get_edge_weight(*ot1);
 			double w = w1 <= w2 ? w1 : w2;
 
@@ -919,9 +932,9 @@ int scallop::classify_trivial_vertex(int x, bool fast)
 	if(d1 != 1 && d2 != 1) return -1;
 
 	edge_iterator it1 = gr.in_edges(x).first;
-	int e1 = e2i[*it1];
+	int e1 = e2i[(*it1)->index()];
 	it1 = gr.out_edges(x).first;
-	int e2 = e2i[*it1];
+	int e2 = e2i[(*it1)->index()];
 
 	if(d1 == 1)
 	{
@@ -965,8 +978,8 @@ int scallop::split_merge_path(const VE &p, double wx)
 	for(int i = 0; i < p.size(); i++)
 	{
 		assert(p[i] != null_edge);
-		assert(e2i.find(p[i]) != e2i.end());
-		v.push_back(e2i[p[i]]);
+		assert(e2i[p[i]->index()] != -1);
+		v.push_back(e2i[p[i]->index()]);
 		double w = gr.get_edge_weight(p[i]);
 	}
 	return split_merge_path(v, wx);
@@ -1006,8 +1019,9 @@ int scallop::merge_adjacent_equal_edges(int x, int y)
 
 	int n = i2e.size();
 	i2e.push_back(p);
-	assert(e2i.find(p) == e2i.end());
-	e2i.insert(PEI(p, n));
+	e2i.resize(gr.num_edge_indices(), -1);
+	assert(e2i[p->index()] == -1);
+	e2i[p->index()] = n;
 
 	double wx0 = gr.get_edge_weight(xx);
 	double wy0 = gr.get_edge_weight(yy);
@@ -1021,11 +1035,11 @@ int scallop::merge_adjacent_equal_edges(int x, int y)
 	gr.set_edge_weight(p, wx0 * 0.5 + wy0 * 0.5);
 	gr.set_edge_info(p, edge_info(lxy));
 
-	vector<int> v = mev[xx];
-	v.insert(v.end(), mev[yy].begin(), mev[yy].end());
+	vector<int> v = mev[xx->index()];
+	v.insert(v.end(), mev[yy->index()].begin(), mev[yy->index()].end());
 
-	if(mev.find(p) != mev.end()) mev[p] = v;
-	else mev.insert(PEV(p, v));
+	mev.resize(gr.num_edge_indices());
+	mev[p->index()] = v;
 
 	double sum1 = gr.get_in_weights(xt);
 	double sum2 = gr.get_out_weights(xt);
@@ -1035,9 +1049,8 @@ int scallop::merge_adjacent_equal_edges(int x, int y)
 	gr.set_vertex_weight(xt, r2);
 
 	assert(i2e[n] == p);
-	assert(e2i.find(p) != e2i.end());
-	assert(e2i[p] == n);
-	assert(e2i[i2e[n]] == n);
+	assert(e2i[p->index()] == n);
+	assert(e2i[i2e[n]->index()] == n);
 
 	remove_edge(x);
 	remove_edge(y);
@@ -1058,7 +1071,7 @@ int scallop::remove_edge(int e)
 	int s = ee->source();
 	int t = ee->target();
 
-	e2i.erase(ee);
+	e2i[ee->index()] = -1;
 	i2e[e] = null_edge;
 	gr.remove_edge(ee);
 
@@ -1125,12 +1138,13 @@ int scallop::split_edge(int ei, double w)
 	gr.set_edge_weight(p2, w);			// new edge
 	gr.set_edge_info(p2, eif);			// new edge
 
-	if(mev.find(p2) != mev.end()) mev[p2] = mev[ee];
-	else mev.insert(PEV(p2, mev[ee]));
+	mev.resize(gr.num_edge_indices());
+	mev[p2->index()] = mev[ee->index()];
 
 	int n = i2e.size();
 	i2e.push_back(p2);
-	e2i.insert(PEI(p2, n));
+	e2i.resize(gr.num_edge_indices(), -1);
+	e2i[p2->index()] = n;
 
 	return n;
 }
@@ -1327,9 +1341,9 @@ int scallop::collect_existing_st_paths()
 
 int scallop::collect_path(int e)
 {
-	assert(mev.find(i2e[e]) != mev.end());
+	assert(i2e[e]->index() < mev.size());
 
-	vector<int> v0 = mev[i2e[e]];
+	vector<int> v0 = mev[i2e[e]->index()];
 	vector<int> v;
 	for(int i = 0; i < v0.size(); i++) 
 	{
@@ -1349,8 +1363,8 @@ int scallop::collect_path(int e)
 	p.v = v;
 	paths.push_back(p);
 
+	e2i[i2e[e]->index()] = -1;
 	gr.remove_edge(i2e[e]);
-	e2i.erase(i2e[e]);
 	i2e[e] = null_edge;
 
 	return 0;
@@ -1407,7 +1421,7 @@ int scallop::compute_smallest_edge(int x, double &ratio)
 		double r = w * 1.0 / sum1;
 		if(r >= ratio) continue;
 		ratio = r;
-		e = e2i[*it1];
+		e = e2i[(*it1)->index()];
 	}
 	for(pei = gr.out_edges(x), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
 	{
@@ -1415,7 +1429,7 @@ int scallop::compute_smallest_edge(int x, double &ratio)
 		double r = w * 1.0 / sum2;
 		if(r >= ratio) continue;
 		ratio = r;
-		e = e2i[*it1];
+		e = e2i[(*it1)->index()];
 	}
 	assert(e >= 0);
 	return e;
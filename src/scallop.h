@@ -13,8 +13,6 @@ See LICENSE for licensing.
 #include "router.h"
 #include "path.h"
 
-typedef map< edge_descriptor, vector<int> > MEV;
-typedef pair< edge_descriptor, vector<int> > PEV;
 typedef pair< vector<int>, vector<int> > PVV;
 typedef pair<PEE, int> PPEEI;
 typedef map<PEE, int> MPEEI;
@@ -30,19 +28,21 @@ public:
 	virtual ~scallop();
 
 public:
+	int init();
 	int assemble();
 
 public:
 	splice_graph gr;					// splice graph
-	MEI e2i;							// edge map, from edge to index
+	vector<int> e2i;					// edge map, from edge index to index
 	VE i2e;								// edge map, from index to edge
-	MEV mev;							// super edges
+	vector< vector<int> > mev;			// super edges, by edge index
 	vector<int> v2v;					// vertex map
 	hyper_set hs;						// hyper edges
 	int round;							// iteration
 	set<int> nonzeroset;				// vertices with degree >= 1
 	vector<path> paths;					// predicted paths
 	vector<transcript> trsts;			// predicted transcripts
+	string *log;						// if not NULL, the summary line is appended here instead of printed
 
 private:
 	// init
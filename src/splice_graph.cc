@@ -25,32 +25,30 @@ splice_graph::splice_graph(const splice_graph &gr)
 	chrm = gr.chrm;
 	gid = gr.gid;
 	strand = gr.strand;
+	copy(gr);
+}
 
-	MEE x2y;
-	MEE y2x;
-	copy(gr, x2y, y2x);
+int splice_graph::copy(const splice_graph &gr)
+{
+	// edge indices are preserved, so properties are copied as arrays
+	directed_graph::copy(gr);
+	vwrt = gr.vwrt;
+	vinf = gr.vinf;
+	ewrt = gr.ewrt;
+	einf = gr.einf;
+	return 0;
 }
 
 int splice_graph::copy(const splice_graph &gr, MEE &x2y, MEE &y2x)
 {
-	clear();
-	for(int i = 0; i < gr.num_vertices(); i++)
-	{
-		add_vertex();
-		set_vertex_weight(i, gr.get_vertex_weight(i));
-		set_vertex_info(i, gr.get_vertex_info(i));
-	}
+	copy(gr);
 
 	PEEI p = gr.edges();
 	for(edge_iterator it = p.first; it != p.second; it++)
 	{
-		edge_descriptor e = add_edge((*it)->source(), (*it)->target());
-		set_edge_weight(e, gr.get_edge_weight(*it));
-		set_edge_info(e, gr.get_edge_info(*it));
+		edge_descriptor e = get_edge((*it)->index());
 
 		assert(e != NULL);
-		assert(ewrt.find(e) != ewrt.end());
-		assert(einf.find(e) != einf.end());
 		assert(x2y.find(*it) == x2y.end());
 		assert(y2x.find(e) == y2x.end());
 
@@ -61,6 +59,19 @@ int splice_graph::copy(const splice_graph &gr, MEE &x2y, MEE &y2x)
 	return 0;
 }
 
+int splice_graph::swap(splice_graph &gr)
+{
+	graph_base::swap(gr);
+	chrm.swap(gr.chrm);
+	gid.swap(gr.gid);
+	std::swap(strand, gr.strand);
+	vwrt.swap(gr.vwrt);
+	vinf.swap(gr.vinf);
+	ewrt.swap(gr.ewrt);
+	einf.swap(gr.einf);
+	return 0;
+}
+
 int splice_graph::clear()
 {
 	directed_graph::clear();
@@ -88,16 +99,16 @@ vertex_info splice_graph::get_vertex_info(int v) const
 
 double splice_graph::get_edge_weight(edge_base *e) const
 {
-	MED::const_iterator it = ewrt.find(e);
-	assert(it != ewrt.end());
-	return it->second;
+	int k = e->index();
+	assert(k >= 0 && k < ewrt.size());
+	return ewrt[k];
 }
 
 edge_info splice_graph::get_edge_info(edge_base *e) const
 {
-	MEIF::const_iterator it = einf.find(e);
-	assert(it != einf.end());
-	return it->second;
+	int k = e->index();
+	assert(k >= 0 && k < einf.size());
+	return einf[k];
 }
 
 int splice_graph::set_vertex_weight(int v, double w) 
@@ -118,19 +129,23 @@ int splice_graph::set_vertex_info(int v, const vertex_info &vi)
 
 int splice_graph::set_edge_weight(edge_base* e, double w) 
 {
-	if(ewrt.find(e) != ewrt.end()) ewrt[e] = w;
-	else ewrt.insert(PED(e, w));
+	int k = e->index();
+	assert(k >= 0 && k < ve.size());
+	if(ewrt.size() != ve.size()) ewrt.resize(ve.size());
+	ewrt[k] = w;
 	return 0;
 }
 
 int splice_graph::set_edge_info(edge_base* e, const edge_info &ei) 
 {
-	if(einf.find(e) != einf.end()) einf[e] = ei;
-	else einf.insert(PEIF(e, ei));
+	int k = e->index();
+	assert(k >= 0 && k < ve.size());
+	if(einf.size() != ve.size()) einf.resize(ve.size());
+	einf[k] = ei;
 	return 0;
 }
 
-MED splice_graph::get_edge_weights() const
+vector<double> splice_graph::get_edge_weights() const
 {
 	return ewrt;
 }
@@ -140,9 +155,9 @@ vector<double> splice_graph::get_vertex_weights() const
 	return vwrt;
 }
 
-int splice_graph::set_edge_weights(const MED &med)
+int splice_graph::set_edge_weights(const vector<double> &v)
 {
-	ewrt = med;
+	ewrt = v;
 	return 0;
 }
 
@@ -383,15 +398,16 @@ int splice_graph::simulate(int nv, int ne, int mw)
 		if(p.second == true) continue;
 
 		edge_descriptor e = add_edge(s, t);
-		ewrt.insert(PED(e, f));
-		einf.insert(PEIF(e, edge_info()));
-		if(ewrt.size() >= ne) break;
+		set_edge_weight(e, f);
+		set_edge_info(e, edge_info());
+		if(num_edges() >= ne) break;
 	}
 
 	assert(in_degree(0) == 0);
 	assert(out_degree(num_vertices() - 1) == 0);
 
-	MED med;
+	vector<double> med(ewrt.size(), 0);
+	vector<bool> used(ewrt.size(), false);
 	while(true)
 	{
 		VE v;
@@ -399,23 +415,23 @@ int splice_graph::simulate(int nv, int ne, int mw)
 		if(w <= 0) break;
 		for(int i = 0; i < v.size(); i++)
 		{
-			ewrt[v[i]] -= w;
-			if(med.find(v[i]) == med.end()) med.insert(PED(v[i], w));
-			else med[v[i]] += w;
+			int k = v[i]->index();
+			ewrt[k] -= w;
+			med[k] += w;
+			used[k] = true;
 		}
 	}
 
-	for(MED::iterator it = ewrt.begin(); it != ewrt.end(); it++)
+	VE vr;
+	PEEI pe = edges();
+	for(edge_iterator it = pe.first; it != pe.second; it++)
 	{
-		if(med.find(it->first) == med.end()) remove_edge(it->first);
+		if(used[(*it)->index()] == false) vr.push_back(*it);
 	}
+	for(int i = 0; i < vr.size(); i++) remove_edge(vr[i]);
 
 	ewrt = med;
-	einf.clear();
-	for(MED::iterator it = ewrt.begin(); it != ewrt.end(); it++)
-	{
-		einf.insert(PEIF(it->first, edge_info()));
-	}
+	einf.assign(ewrt.size(), edge_info());
 
 	edge_iterator it1, it2;
 	PEEI pei;
@@ -424,12 +440,12 @@ int splice_graph::simulate(int nv, int ne, int mw)
 		int wx = 0;
 		for(pei = in_edges(i), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
 		{
-			wx += (int)(ewrt[*it1]);
+			wx += (int)(get_edge_weight(*it1));
 		}
 		int wy = 0;
 		for(pei = out_edges(i), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
 		{
-			wy += (int)(ewrt[*it1]);
+			wy += (int)(get_edge_weight(*it1));
 		}
 
 		if(i == 0) assert(wx == 0);
@@ -701,15 +717,23 @@ double splice_graph::compute_maximum_path_w(VE &p)
 }
 
 double splice_graph::compute_maximum_st_path_w(VE &p, int ss, int tt)
+{
+	csr_graph cg;
+	cg.build(*this);
+	vector<int> tp = cg.topological_sort();
+	return compute_maximum_st_path_w(cg, tp, p, ss, tt);
+}
+
+double splice_graph::compute_maximum_st_path_w(const csr_graph &cg, const vector<int> &tp, VE &p, int ss, int tt)
 {
 	p.clear();
 	vector<double> table;		// dynamic programming table
-	VE back;					// backtrace edge pointers
+	vector<int> back;			// backtrace edge indices
 	table.resize(num_vertices(), -1);
-	back.resize(num_vertices(), null_edge);
+	back.resize(num_vertices(), -1);
 
-	vector<int> tp = topological_sort();
 	int n = num_vertices();
+	assert(cg.num_vertices() == n);
 	assert(tp.size() == n);
 	//assert(tp[0] == 0);
 	//assert(tp[n - 1] == n - 1);
@@ -728,28 +752,26 @@ double splice_graph::compute_maximum_st_path_w(VE &p, int ss, int tt)
 	for(int ii = ssi + 1; ii <= tti; ii++)
 	{
 		int i = tp[ii];
-		if(degree(i) == 0) continue;
+		if(cg.degree(i) == 0) continue;
 
 		double max_abd = 0;
-		edge_descriptor max_edge = null_edge;
-		edge_iterator it1, it2;
-		PEEI pei;
-		for(pei = in_edges(i), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
+		int max_edge = -1;
+		for(int j = cg.ip[i]; j < cg.ip[i + 1]; j++)
 		{
-			int s = (*it1)->source();
-			int t = (*it1)->target();
-			assert(t == i);
+			int k = cg.ie[j];
+			int s = cg.es[k];
+			assert(cg.et[k] == i);
 			if(table[s] <= -1) continue;
-			double xw = get_edge_weight(*it1);
+			double xw = get_edge_weight(get_edge(k));
 			double ww = xw < table[s] ? xw : table[s];
 			if(ww >= max_abd)
 			{
 				max_abd = ww;
-				max_edge = *it1;
+				max_edge = k;
 			}
 		}
 
-		if(max_edge == null_edge) continue;
+		if(max_edge == -1) continue;
 
 		back[i] = max_edge;
 		table[i] = max_abd;
@@ -758,10 +780,10 @@ double splice_graph::compute_maximum_st_path_w(VE &p, int ss, int tt)
 	int x = tt;
 	while(true)
 	{
-		edge_descriptor e = back[x]; 
-		if(e == null_edge) break;
-		p.push_back(e);
-		x = e->source();
+		int k = back[x]; 
+		if(k == -1) break;
+		p.push_back(get_edge(k));
+		x = cg.es[k];
 	}
 	reverse(p.begin(), p.end());
 
@@ -875,11 +897,12 @@ int splice_graph::locate(int v)
 
 int splice_graph::round_weights()
 {
-	MED m = ewrt;
-	for(MED::iterator it = m.begin(); it != m.end(); it++)
-	{
-		it->second = 0.0;
-	}
+	vector<double> m(ewrt.size(), 0.0);
+
+	// only weights change below, so one snapshot serves all paths
+	csr_graph cg;
+	cg.build(*this);
+	vector<int> tp = cg.topological_sort();
 
 	while(true)
 	{
@@ -893,8 +916,8 @@ int splice_graph::round_weights()
 		double w1 = w0;
 		double w2 = w0;
 
-		if(e->source() != 0) w1 = compute_maximum_st_path_w(v1, 0, e->source());
-		if(e->target() != num_vertices() - 1) w2 = compute_maximum_st_path_w(v2, e->target(), num_vertices() - 1);
+		if(e->source() != 0) w1 = compute_maximum_st_path_w(cg, tp, v1, 0, e->source());
+		if(e->target() != num_vertices() - 1) w2 = compute_maximum_st_path_w(cg, tp, v2, e->target(), num_vertices() - 1);
 
 		assert(w1 <= w0);
 		assert(w2 <= w0);
@@ -909,9 +932,10 @@ int splice_graph::round_weights()
 		
 		for(int i = 0; i < v.size(); i++)
 		{
-			m[v[i]] += ww;
-			ewrt[v[i]] -= ww;
-			if(ewrt[v[i]] <= 0) ewrt[v[i]] = 0;
+			int k = v[i]->index();
+			m[k] += ww;
+			ewrt[k] -= ww;
+			if(ewrt[k] <= 0) ewrt[k] = 0;
 		}
 	}
 
@@ -921,7 +945,7 @@ int splice_graph::round_weights()
 	PEEI pei;
 	for(pei = out_edges(0), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
 	{
-		double w = ewrt[*it1];
+		double w = get_edge_weight(*it1);
 		vwrt[0] += w;
 	}
 
@@ -929,7 +953,7 @@ int splice_graph::round_weights()
 	{
 		for(pei = in_edges(i), it1 = pei.first, it2 = pei.second; it1 != it2; it1++)
 		{
-			double w = ewrt[*it1];
+			double w = get_edge_weight(*it1);
 			vwrt[i] += w;
 		}
 	}
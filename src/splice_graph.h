@@ -8,6 +8,7 @@ See LICENSE for licensing.
 #define __SPLICE_GRAPH_H__
 
 #include "directed_graph.h"
+#include "csr_graph.h"
 #include "vertex_info.h"
 #include "edge_info.h"
 #include "path.h"
@@ -20,9 +21,6 @@ See LICENSE for licensing.
 
 using namespace std;
 
-typedef map<edge_descriptor, edge_info> MEIF;
-typedef pair<edge_descriptor, edge_info> PEIF;
-
 class splice_graph : public directed_graph
 {
 public:
@@ -37,8 +35,8 @@ public:
 
 	vector<double> vwrt;
 	vector<vertex_info> vinf;
-	MED ewrt;
-	MEIF einf;
+	vector<double> ewrt;		// edge weights, by edge index
+	vector<edge_info> einf;		// edge infos, by edge index
 
 public:
 	// get and set properties
@@ -52,9 +50,9 @@ public:
 	int set_edge_weight(edge_base *e, double w);
 	int set_edge_info(edge_base *e, const edge_info &ei);
 
-	MED get_edge_weights() const;
+	vector<double> get_edge_weights() const;
 	vector<double> get_vertex_weights() const;
-	int set_edge_weights(const MED & med);
+	int set_edge_weights(const vector<double> &v);
 	int set_vertex_weights(const vector<double> &v);
 
 	edge_descriptor max_out_edge(int v);
@@ -68,7 +66,9 @@ public:
 
 	// modify the splice_graph
 	int clear();
+	int copy(const splice_graph &gr);
 	int copy(const splice_graph &gr, MEE &x2y, MEE &y2x);
+	int swap(splice_graph &gr);
 
 	// read, write, and simulate splice graph
 	int build(const string &file);
@@ -95,6 +95,7 @@ public:
 	int compute_closest_path_reverse(int t, vector<double> &d, vector<int> &b);
 	double compute_maximum_path_w(VE &p);
 	double compute_maximum_st_path_w(VE &p, int s, int t);
+	double compute_maximum_st_path_w(const csr_graph &cg, const vector<int> &tp, VE &p, int s, int t);
 	double compute_minimum_weight(const VE &p);
 
 	// determine optimal path
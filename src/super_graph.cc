@@ -56,6 +56,8 @@ int super_graph::split_splice_graph()
 	vector< set<int> > vv = ug.compute_connected_components();
 	a2b.clear();
 	b2a.clear();
+	subs.reserve(vv.size());
+	hss.reserve(vv.size());
 	int index = 0;
 	for(int k = 0; k < vv.size(); k++)
 	{
@@ -67,8 +69,12 @@ int super_graph::split_splice_graph()
 		split_single_splice_graph(gr, hs, s, index);
 		gr.chrm = root.chrm;
 		gr.strand = root.strand;
-		subs.push_back(gr);
-		hss.push_back(hs);
+
+		// move into place instead of copying
+		subs.push_back(splice_graph());
+		hss.push_back(hyper_set());
+		subs.back().swap(gr);
+		hss.back().swap(hs);
 		index++;
 	}
 	return 0;
@@ -152,20 +158,20 @@ int super_graph::split_single_splice_graph(splice_graph &gr, hyper_set &hs, cons
 
 	// hyper-set
 	hs.clear();
-	for(MVII::iterator it = hyper.nodes.begin(); it != hyper.nodes.end(); it++)
+	for(int i = 0; i < hyper.num_node_lists(); i++)
 	{
-		vector<int> v = it->first;
-		int c = it->second;
+		int c = hyper.nc[i];
 
 		bool b = true;
 		vector<int> vv;
-		for(int k = 0; k < v.size(); k++)
+		for(int k = hyper.np[i]; k < hyper.np[i + 1]; k++)
 		{
-			if(ss.find(v[k]) == ss.end()) b = false;
+			int u = hyper.nv[k];
+			if(ss.find(u) == ss.end()) b = false;
 			if(b == false) break;
-			assert(a2b.find(v[k]) != a2b.end());
-			assert(a2b[v[k]].first == index);
-			int x = a2b[v[k]].second;
+			assert(a2b.find(u) != a2b.end());
+			assert(a2b[u].first == index);
+			int x = a2b[u].second;
 			vv.push_back(x);
 		}
 
@@ -0,0 +1,334 @@
+/*
+Part of Scallop Transcript Assembler
+(c) 2017 by  Mingfu Shao, Carl Kingsford, and Carnegie Mellon University.
+See LICENSE for licensing.
+*/
+
+// Benchmark of decoding alignment records into hits. Records are built
+// in memory with a fixed seed, so runs at different revisions see the
+// same input and print the same checksum if they decode it identically.
+//
+//   hit_bench tags [n]     construct + set_tags, STAR- and HISAT2-style tags
+//   hit_bench random [n]   set_tags on random tag lists, for the checksum
+//   hit_bench decode [n]   construct + set_strand + attach, 21% spliced
+//   hit_bench strand       set_strand for every flag and library type
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "hit.h"
+#include "config.h"
+#include "util.h"
+
+using namespace std;
+
+// a BAM record, kept as its core fields and data bytes
+class record
+{
+public:
+	bam1_core_t core;
+	vector<uint8_t> data;
+
+public:
+	int load(bam1_t &b);
+};
+
+int record::load(bam1_t &b)
+{
+	b.core = core;
+	b.data = &data[0];
+	b.l_data = data.size();
+	b.m_data = data.size();
+	return 0;
+}
+
+static int put_bytes(vector<uint8_t> &d, const void *p, int n)
+{
+	const uint8_t *s = (const uint8_t*)p;
+	d.insert(d.end(), s, s + n);
+	return 0;
+}
+
+static int put_tag(vector<uint8_t> &d, const char *tag, char type)
+{
+	d.push_back(tag[0]);
+	d.push_back(tag[1]);
+	d.push_back(type);
+	return 0;
+}
+
+static int put_int(vector<uint8_t> &d, const char *tag, char type, int32_t x)
+{
+	put_tag(d, tag, type);
+	if(type == 'c' || type == 'C') d.push_back((uint8_t)(x));
+	if(type == 's' || type == 'S') { int16_t v = x; put_bytes(d, &v, 2); }
+	if(type == 'i' || type == 'I') put_bytes(d, &x, 4);
+	return 0;
+}
+
+static int put_char(vector<uint8_t> &d, const char *tag, char type, char c)
+{
+	put_tag(d, tag, type);
+	d.push_back(c);
+	if(type == 'Z') d.push_back(0);
+	return 0;
+}
+
+static int put_string(vector<uint8_t> &d, const char *tag, const string &s)
+{
+	put_tag(d, tag, 'Z');
+	put_bytes(d, s.c_str(), s.size() + 1);
+	return 0;
+}
+
+static int put_array(vector<uint8_t> &d, const char *tag, char type, int32_t n)
+{
+	put_tag(d, tag, 'B');
+	d.push_back(type);
+	put_bytes(d, &n, 4);
+	int w = (type == 'c' || type == 'C') ? 1 : ((type == 's' || type == 'S') ? 2 : 4);
+	for(int i = 0; i < n * w; i++) d.push_back(rand() % 256);
+	return 0;
+}
+
+// fill core, name, cigar, sequence and qualities of a 101 bp read
+static int make_alignment(record &r, int i, bool spliced)
+{
+	static const uint16_t flags[] = {99, 147, 83, 163, 355, 403, 0, 16};
+
+	char name[64];
+	sprintf(name, "SRR1234567.%d", i / 2);
+	int l = strlen(name) + 1;
+	int p = (4 - l % 4) % 4;
+
+	vector<uint32_t> cigar;
+	if(spliced == true)
+	{
+		int a = 10 + rand() % 80;
+		cigar.push_back((a << 4) | BAM_CMATCH);
+		cigar.push_back(((100 + rand() % 5000) << 4) | BAM_CREF_SKIP);
+		cigar.push_back(((101 - a) << 4) | BAM_CMATCH);
+	}
+	else if(rand() % 10 == 0)
+	{
+		cigar.push_back((50 << 4) | BAM_CMATCH);
+		cigar.push_back((1 << 4) | BAM_CDEL);
+		cigar.push_back((51 << 4) | BAM_CMATCH);
+	}
+	else
+	{
+		cigar.push_back((101 << 4) | BAM_CMATCH);
+	}
+
+	memset(&r.core, 0, sizeof(r.core));
+	r.core.tid = 0;
+	r.core.pos = 1000 + 7 * i;
+	r.core.qual = 255;
+	r.core.l_qname = l + p;
+	r.core.flag = flags[rand() % 8];
+	r.core.n_cigar = cigar.size();
+	r.core.l_qseq = 101;
+	r.core.mtid = 0;
+	r.core.mpos = r.core.pos + 150;
+	r.core.isize = 250;
+
+	r.data.clear();
+	put_bytes(r.data, name, l);
+	r.data.insert(r.data.end(), p, 0);
+	put_bytes(r.data, &cigar[0], 4 * cigar.size());
+	for(int k = 0; k < 51; k++) r.data.push_back(rand() % 256);
+	for(int k = 0; k < 101; k++) r.data.push_back(30 + rand() % 10);
+	return 0;
+}
+
+// tags in the order STAR writes them
+static int make_star(record &r, int i)
+{
+	bool spliced = (rand() % 100 < 21);
+	make_alignment(r, i, spliced);
+	vector<uint8_t> &d = r.data;
+	put_int(d, "NH", 'C', 1 + rand() % 3);
+	put_int(d, "HI", 'C', 1);
+	put_int(d, "AS", 'C', 190 + rand() % 10);
+	put_int(d, "nM", 'C', rand() % 3);
+	put_int(d, "NM", 'C', rand() % 3);
+	put_string(d, "MD", "50A50");
+	put_array(d, "jM", 'c', 1);
+	put_array(d, "jI", 'i', spliced ? 2 : 1);
+	if(spliced == true) put_char(d, "XS", 'A', (rand() % 2 == 0) ? '+' : '-');
+	put_string(d, "MC", "101M");
+	put_string(d, "RG", "sample1");
+	return 0;
+}
+
+// tags in the order HISAT2 writes them, with NH near the end
+static int make_hisat(record &r, int i)
+{
+	bool spliced = (rand() % 100 < 21);
+	make_alignment(r, i, spliced);
+	vector<uint8_t> &d = r.data;
+	put_int(d, "AS", 'c', -(rand() % 10));
+	put_int(d, "ZS", 'c', -(rand() % 20));
+	put_int(d, "XN", 'C', 0);
+	put_int(d, "XM", 'C', rand() % 3);
+	put_int(d, "XO", 'C', 0);
+	put_int(d, "XG", 'C', 0);
+	put_int(d, "NM", 'C', rand() % 3);
+	put_int(d, "YS", 'c', -(rand() % 10));
+	put_string(d, "YT", "CP");
+	if(spliced == true) put_char(d, "XS", 'A', (rand() % 2 == 0) ? '+' : '-');
+	put_int(d, "NH", 'C', 1 + rand() % 3);
+	put_string(d, "MD", "50A50");
+	return 0;
+}
+
+// random tag lists, with repeated tags, mixed integer types and non-'A' XS/ts
+static int make_random(record &r, int i)
+{
+	static const char *tags[] = {"ts", "XS", "HI", "NH", "nM", "NM", "AS", "MD"};
+	static const char itypes[] = {'c', 'C', 's', 'S', 'i', 'I'};
+	static const char strands[] = {'+', '-', '.', '?'};
+
+	make_alignment(r, i, rand() % 2 == 0);
+	vector<uint8_t> &d = r.data;
+	int n = rand() % 10;
+	for(int k = 0; k < n; k++)
+	{
+		const char *t = tags[rand() % 8];
+		int c = rand() % 5;
+		if(c == 0) put_char(d, t, 'A', strands[rand() % 4]);
+		if(c == 1) put_char(d, t, 'Z', strands[rand() % 4]);
+		if(c == 2) put_string(d, t, "10A90");
+		if(c == 3) put_array(d, t, itypes[rand() % 6], rand() % 4);
+		if(c == 4) put_int(d, t, itypes[rand() % 6], rand() % 100);
+	}
+	return 0;
+}
+
+static uint64_t mix(uint64_t x, int64_t v)
+{
+	return (x ^ (uint64_t)(v)) * 1099511628211ull;
+}
+
+static uint64_t tag_checksum(uint64_t x, const hit &h)
+{
+	x = mix(x, h.ts);
+	x = mix(x, h.xs);
+	x = mix(x, h.hi);
+	x = mix(x, h.nh);
+	x = mix(x, h.nm);
+	return x;
+}
+
+static int bench_tags(long n, bool random)
+{
+	vector<record> v(random ? 20000 : 4096);
+	srand(1);
+	for(int i = 0; i < v.size(); i++)
+	{
+		if(random == true) make_random(v[i], i);
+		else if(i % 2 == 0) make_star(v[i], i);
+		else make_hisat(v[i], i);
+	}
+
+	bam1_t b;
+	memset(&b, 0, sizeof(b));
+	uint64_t x = 14695981039346656037ull;
+
+	double t = get_wall_time();
+	for(long i = 0; i < n; i++)
+	{
+		v[i % v.size()].load(b);
+		hit h(&b);
+		h.set_tags(&b);
+		x = tag_checksum(x, h);
+	}
+	t = get_wall_time() - t;
+
+	printf("%s: %ld records, checksum %016llx, %.2lf seconds\n", random ? "random" : "tags", n, (unsigned long long)(x), t);
+	return 0;
+}
+
+static int bench_decode(long n)
+{
+	vector<record> v(4096);
+	srand(1);
+	for(int i = 0; i < v.size(); i++) make_alignment(v[i], i, rand() % 100 < 21);
+
+	bam1_t b;
+	memset(&b, 0, sizeof(b));
+	uint64_t x = 14695981039346656037ull;
+	library_type = FR_FIRST;
+	arena a;
+
+	double t = get_wall_time();
+	for(long i = 0; i < n; i++)
+	{
+		// release the arena now and then, as closed bundles do
+		if(i % 100000 == 0) a.clear();
+
+		v[i % v.size()].load(b);
+		hit h(&b);
+		h.set_strand();
+		h.attach(a);
+
+		x = mix(x, h.rpos);
+		x = mix(x, h.qlen);
+		x = mix(x, h.strand);
+		x = mix(x, h.n_spos);
+		for(int k = 0; k < h.n_spos; k++) x = mix(x, h.spos[k]);
+	}
+	t = get_wall_time() - t;
+
+	printf("decode: %ld records, checksum %016llx, %.2lf seconds\n", n, (unsigned long long)(x), t);
+	return 0;
+}
+
+static int bench_strand()
+{
+	record r;
+	srand(1);
+	make_alignment(r, 0, false);
+
+	bam1_t b;
+	memset(&b, 0, sizeof(b));
+	r.load(b);
+	hit h(&b);
+
+	uint64_t x = 14695981039346656037ull;
+	for(library_type = EMPTY; library_type <= FR_SECOND; library_type++)
+	{
+		for(int f = 0; f < 65536; f++)
+		{
+			h.flag = f;
+			h.set_strand();
+			x = mix(x, h.strand);
+		}
+	}
+
+	printf("strand: %d flags, checksum %016llx\n", 65536, (unsigned long long)(x));
+	return 0;
+}
+
+int main(int argc, const char **argv)
+{
+	if(argc < 2)
+	{
+		printf("usage: %s tags|random|decode|strand [number-of-records]\n", argv[0]);
+		return 0;
+	}
+
+	string mode(argv[1]);
+	long n = (argc >= 3) ? atol(argv[2]) : -1;
+
+	if(mode == "tags") return bench_tags(n >= 0 ? n : 10000000, false);
+	if(mode == "random") return bench_tags(n >= 0 ? n : 20000, true);
+	if(mode == "decode") return bench_decode(n >= 0 ? n : 10000000);
+	if(mode == "strand") return bench_strand();
+
+	printf("unknown mode %s\n", mode.c_str());
+	return 0;
+}
@@ -0,0 +1,326 @@
+/*
+Part of Scallop Transcript Assembler
+(c) 2017 by  Mingfu Shao, Carl Kingsford, and Carnegie Mellon University.
+See LICENSE for licensing.
+*/
+
+// Assembles random splice graphs, built from a fixed seed, and checks
+// properties that the output must have. Exits with 1 if a check fails.
+//
+//   random_graphs [n]          run the checks on n graphs and n sets of
+//                              node lists (default 1000)
+//   random_graphs print [n]    print the transcripts and edges of n graphs,
+//                              to compare the output of two revisions
+//
+// The checks:
+// - placement: the graph is built again after adding and removing
+//   temporary edges, so that its edges get other indices and addresses
+//   (but the same relative order); the transcripts must be the same.
+// - moving: scallop takes over each sub-graph by swap, as the assembler
+//   does, instead of copying it; the transcripts must be the same.
+// - copying: a clone of the graph gives the same transcripts.
+// - node lists: random lists, with many repeats, are added to a hyper_set;
+//   the deduplicated lists and counts must match a map-based reference.
+//
+// To run the checks under AddressSanitizer:
+//   make -C test check SANITIZE=-fsanitize=address
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <sstream>
+#include <algorithm>
+
+#include "splice_graph.h"
+#include "hyper_set.h"
+#include "super_graph.h"
+#include "scallop.h"
+#include "config.h"
+#include "util.h"
+
+using namespace std;
+
+// a random graph, kept as a list of vertices, edges and phasing paths
+class random_graph
+{
+public:
+	vector<vertex_info> vis;		// vertices
+	vector<double> vws;				// vertex weights
+	vector<PI> es;					// edges
+	vector<double> ews;				// edge weights
+	vector< vector<int> > paths;	// phasing paths
+	vector<int> pcnts;				// counts of phasing paths
+
+public:
+	int generate(int seed);
+	int build(splice_graph &gr, hyper_set &hs, int temp);
+};
+
+int random_graph::generate(int seed)
+{
+	srand(seed + 1);
+
+	int n = 10 + rand() % 60;
+	int32_t pos = 100;
+	for(int i = 0; i < n + 2; i++)
+	{
+		vertex_info vi;
+		int len = 1 + rand() % 80;
+		vi.lpos = pos;
+		vi.rpos = pos + len;
+		vi.length = len;
+		vi.stddev = (rand() % 4 == 0) ? 0.0 : 1.0;
+		vis.push_back(vi);
+		vws.push_back(1 + (rand() % 3 == 0 ? rand() % 5 : rand() % 400));
+		pos = vi.rpos + ((rand() % 3 == 0) ? rand() % 50 : 0);
+	}
+
+	set<PI> s;
+	for(int i = 1; i <= n; i++)
+	{
+		if(rand() % 3 == 0 && s.insert(PI(0, i)).second) es.push_back(PI(0, i));
+		if(rand() % 3 == 0 && s.insert(PI(i, n + 1)).second) es.push_back(PI(i, n + 1));
+		int k = rand() % 3;
+		for(int j = 0; j < k; j++)
+		{
+			int t = i + 1 + rand() % 5;
+			if(t > n) continue;
+			if(s.insert(PI(i, t)).second) es.push_back(PI(i, t));
+		}
+	}
+
+	// every inner vertex needs an in-edge and an out-edge
+	vector<int> din(n + 2, 0), dout(n + 2, 0);
+	for(int i = 0; i < es.size(); i++) dout[es[i].first]++;
+	for(int i = 0; i < es.size(); i++) din[es[i].second]++;
+	for(int i = 1; i <= n; i++)
+	{
+		if(din[i] == 0) es.push_back(PI(0, i));
+		if(dout[i] == 0) es.push_back(PI(i, n + 1));
+	}
+	for(int i = 0; i < es.size(); i++) ews.push_back(1 + rand() % 50);
+
+	// phasing paths follow the edges
+	vector< vector<int> > out(n + 2);
+	for(int i = 0; i < es.size(); i++) out[es[i].first].push_back(es[i].second);
+	for(int r = 0; r < 3 * n; r++)
+	{
+		int v = 1 + rand() % n;
+		vector<int> p(1, v);
+		int m = 1 + rand() % 4;
+		for(int j = 0; j < m; j++)
+		{
+			if(out[v].size() == 0) break;
+			int w = out[v][rand() % out[v].size()];
+			if(w == n + 1) break;
+			p.push_back(w);
+			v = w;
+		}
+		if(p.size() <= 1) continue;
+		paths.push_back(p);
+		pcnts.push_back(1 + rand() % 20);
+	}
+	return 0;
+}
+
+int random_graph::build(splice_graph &gr, hyper_set &hs, int temp)
+{
+	gr.clear();
+	hs.clear();
+
+	for(int i = 0; i < vis.size(); i++)
+	{
+		gr.add_vertex();
+		gr.set_vertex_info(i, vis[i]);
+		gr.set_vertex_weight(i, vws[i]);
+	}
+
+	// temporary edges, removed in a shuffled order, so that the real
+	// edges reuse their indices in that order
+	vector<edge_descriptor> v;
+	for(int i = 0; i < temp; i++) v.push_back(gr.add_edge(0, vis.size() - 1));
+	random_shuffle(v.begin(), v.end());
+	for(int i = 0; i < v.size(); i++) gr.remove_edge(v[i]);
+
+	for(int i = 0; i < es.size(); i++)
+	{
+		edge_descriptor e = gr.add_edge(es[i].first, es[i].second);
+		gr.set_edge_weight(e, ews[i]);
+		gr.set_edge_info(e, edge_info());
+	}
+
+	for(int i = 0; i < paths.size(); i++) hs.add_node_list(paths[i], pcnts[i]);
+
+	gr.strand = '+';
+	gr.chrm = "chr1";
+	return 0;
+}
+
+// assemble gr and hs, and write the transcripts to s; with move, the
+// sub-graphs are swapped into scallop rather than copied
+int assemble(splice_graph &gr, hyper_set &hs, const string &gid, string &s, bool move)
+{
+	super_graph sg(gr, hs);
+	sg.build();
+
+	ostringstream os;
+	for(int k = 0; k < sg.subs.size(); k++)
+	{
+		sg.subs[k].gid = gid + "." + tostring(k);
+		if(move == false)
+		{
+			scallop sc(sg.subs[k], sg.hss[k]);
+			sc.assemble();
+			for(int i = 0; i < sc.trsts.size(); i++) sc.trsts[i].write(os);
+			continue;
+		}
+
+		scallop sc;
+		sc.gr.swap(sg.subs[k]);
+		sc.hs.swap(sg.hss[k]);
+		sc.init();
+		sc.assemble();
+		for(int i = 0; i < sc.trsts.size(); i++) sc.trsts[i].write(os);
+	}
+	s = os.str();
+	return 0;
+}
+
+// edges of gr in the order of gr.edges()
+string write_edges(const splice_graph &gr)
+{
+	ostringstream os;
+	PEEI pei = gr.edges();
+	for(edge_iterator it = pei.first; it != pei.second; it++)
+	{
+		os << " " << (*it)->source() << "-" << (*it)->target();
+	}
+	return os.str();
+}
+
+int print_graphs(int n)
+{
+	for(int i = 0; i < n; i++)
+	{
+		random_graph rg;
+		rg.generate(i);
+
+		splice_graph gr;
+		hyper_set hs;
+		rg.build(gr, hs, 0);
+		string e = write_edges(gr);
+
+		string s;
+		assemble(gr, hs, "g" + tostring(i), s, false);
+		printf("%sgraph %d:%s\n", s.c_str(), i, e.c_str());
+	}
+	return 0;
+}
+
+int check_graphs(int n)
+{
+	int failed = 0;
+	for(int i = 0; i < n; i++)
+	{
+		random_graph rg;
+		rg.generate(i);
+		string gid = "g" + tostring(i);
+
+		splice_graph gr1, gr2;
+		hyper_set hs1, hs2;
+		rg.build(gr1, hs1, 0);
+		rg.build(gr2, hs2, 1 + rand() % 50);
+
+		splice_graph gr3(gr2);
+
+		string s1, s2, s3, s4;
+		assemble(gr1, hs1, gid, s1, false);
+		assemble(gr2, hs2, gid, s2, false);
+		assemble(gr2, hs2, gid, s3, true);
+		assemble(gr3, hs2, gid, s4, true);
+
+		if(s1 != s2) printf("graph %d: transcripts depend on the placement of edges\n", i);
+		if(s2 != s3) printf("graph %d: moving sub-graphs into scallop changes the transcripts\n", i);
+		if(s3 != s4) printf("graph %d: a copy of the graph gives other transcripts\n", i);
+		if(s1 != s2 || s2 != s3 || s3 != s4) failed++;
+	}
+
+	printf("random_graphs: %d graphs, %d failed\n", n, failed);
+	return (failed == 0) ? 0 : 1;
+}
+
+// add random node lists to a hyper_set and to a map, as hyper_set kept
+// them before, and compare the lists and their counts
+int check_node_lists(int n)
+{
+	int failed = 0;
+	for(int i = 0; i < n; i++)
+	{
+		srand(i + 1);
+		hyper_set hs, hs2;
+		map<vector<int>, int> ref;
+
+		int m = 1 + rand() % 2000;
+		for(int k = 0; k < m; k++)
+		{
+			// few nodes, so that most lists are repeats
+			set<int> s;
+			int l = 1 + rand() % 4;
+			for(int j = 0; j < l; j++) s.insert(rand() % 12);
+			int c = 1 + rand() % 10;
+
+			vector<int> v;
+			for(set<int>::iterator it = s.begin(); it != s.end(); it++) v.push_back(*it + 1);
+			ref[v] += c;
+
+			if(rand() % 2 == 0)
+			{
+				hs.add_node_list(s, c);
+				continue;
+			}
+			vector<int> u(s.begin(), s.end());
+			random_shuffle(u.begin(), u.end());
+			hs.add_node_list(u, c);
+
+			// the table must survive being swapped away and back
+			if(rand() % 100 == 0)
+			{
+				hs2.swap(hs);
+				hs.swap(hs2);
+			}
+		}
+
+		map<vector<int>, int> got;
+		for(int k = 0; k < hs.num_node_lists(); k++)
+		{
+			vector<int> v(hs.nv.begin() + hs.np[k], hs.nv.begin() + hs.np[k + 1]);
+			got[v] += hs.nc[k];
+		}
+
+		if(got.size() != hs.num_node_lists()) printf("node lists %d: a list is stored twice\n", i);
+		if(got != ref) printf("node lists %d: lists or counts differ from the reference\n", i);
+		if(got.size() != hs.num_node_lists() || got != ref) failed++;
+	}
+
+	printf("random_graphs: %d sets of node lists, %d failed\n", n, failed);
+	return (failed == 0) ? 0 : 1;
+}
+
+int main(int argc, const char **argv)
+{
+	verbose = 0;
+
+	if(argc >= 2 && string(argv[1]) == "print")
+	{
+		int n = (argc >= 3) ? atoi(argv[2]) : 1000;
+		return print_graphs(n);
+	}
+
+	int n = (argc >= 2) ? atoi(argv[1]) : 1000;
+	int a = check_graphs(n);
+	int b = check_node_lists(n);
+	return (a == 0 && b == 0) ? 0 : 1;
+}